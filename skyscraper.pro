@@ -73,21 +73,33 @@ include(win32/skyscraper.pro)
 HEADERS += src/skyscraper.h \
            src/netmanager.h \
            src/netcomm.h \
+           src/ratelimiter.h \
+           src/httpcache.h \
+           src/retrypolicy.h \
+           src/netarchive.h \
+           src/coalescer.h \
            src/xmlreader.h \
            src/settings.h \
            src/cli.h \
            src/compositor.h \
+           src/renderpool.h \
            src/config.h \
            src/strtools.h \
            src/imgtools.h \
            src/esgamelist.h \
            src/scraperworker.h \
+           src/scrapepipeline.h \
+           src/reportwriter.h \
+           src/boundedqueue.h \
            src/cache.h \
+           src/cachebin.h \
+           src/quickidstore.h \
            src/localscraper.h \
            src/importscraper.h \
            src/gameentry.h \
            src/abstractscraper.h \
            src/abstractfrontend.h \
+           src/gamelistwriter.h \
            src/emulationstation.h \
            src/esde.h \
            src/attractmode.h \
@@ -125,21 +137,32 @@ SOURCES += src/main.cpp \
            src/skyscraper.cpp \
            src/netmanager.cpp \
            src/netcomm.cpp \
+           src/ratelimiter.cpp \
+           src/httpcache.cpp \
+           src/retrypolicy.cpp \
+           src/netarchive.cpp \
+           src/coalescer.cpp \
            src/xmlreader.cpp \
            src/settings.cpp \
            src/cli.cpp \
            src/compositor.cpp \
+           src/renderpool.cpp \
            src/config.cpp \
            src/strtools.cpp \
            src/imgtools.cpp \
            src/esgamelist.cpp \
            src/scraperworker.cpp \
+           src/scrapepipeline.cpp \
+           src/reportwriter.cpp \
            src/cache.cpp \
+           src/cachebin.cpp \
+           src/quickidstore.cpp \
            src/localscraper.cpp \
            src/importscraper.cpp \
            src/gameentry.cpp \
            src/abstractscraper.cpp \
            src/abstractfrontend.cpp \
+           src/gamelistwriter.cpp \
            src/emulationstation.cpp \
            src/esde.cpp \
            src/attractmode.cpp \
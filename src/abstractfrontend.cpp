@@ -25,6 +25,10 @@
 
 #include "abstractfrontend.h"
 
+#include <QPair>
+#include <algorithm>
+#include <vector>
+
 AbstractFrontend::AbstractFrontend() {}
 
 AbstractFrontend::~AbstractFrontend() {}
@@ -33,25 +37,27 @@ void AbstractFrontend::setConfig(Settings *config) { this->config = config; }
 
 void AbstractFrontend::sortEntries(QList<GameEntry> &gameEntries) {
     printf("Sorting entries...");
-    int dots = 0;
-    std::sort(gameEntries.begin(), gameEntries.end(),
-              [&dots](const GameEntry a, const GameEntry b) -> bool {
-                  if (dots % 1000 == 0) {
-                      printf(".");
-                      fflush(stdout);
-                  }
-                  dots++;
-                  QString firstTitle = a.title.toLower();
-                  QString secondTitle = b.title.toLower();
-                  if (firstTitle.left(4) == "the ") {
-                      firstTitle.remove(0, 4);
-                  }
-                  if (secondTitle.left(4) == "the ") {
-                      secondTitle.remove(0, 4);
-                  }
-
-                  return firstTitle < secondTitle;
-              });
+    fflush(stdout);
+    // Work out the sort key of every entry once and sort those. The entries
+    // themselves are only moved into place at the end
+    std::vector<QPair<QString, int>> keys;
+    keys.reserve(gameEntries.size());
+    for (int a = 0; a < gameEntries.size(); ++a) {
+        QString title = gameEntries.at(a).title.toLower();
+        if (title.left(4) == "the ") {
+            title.remove(0, 4);
+        }
+        keys.push_back(qMakePair(title, a));
+    }
+    std::sort(keys.begin(), keys.end());
+
+    QList<GameEntry> sorted;
+    sorted.reserve(gameEntries.size());
+    for (const auto &key : keys) {
+        sorted.append(GameEntry());
+        sorted.last() = std::move(gameEntries[key.second]);
+    }
+    gameEntries.swap(sorted);
     printf(" \033[1;32mDone!\033[0m\n");
 }
 
@@ -27,6 +27,7 @@
 #define ABSTRACTFRONTEND_H
 
 #include "gameentry.h"
+#include "gamelistwriter.h"
 #include "queue.h"
 #include "settings.h"
 
@@ -42,7 +43,7 @@ public:
     virtual ~AbstractFrontend();
     void setConfig(Settings *config);
     virtual void checkReqs(){};
-    virtual void assembleList(QString &, QList<GameEntry> &){};
+    virtual void assembleList(GameListWriter &, QList<GameEntry> &){};
     virtual bool skipExisting(QList<GameEntry> &, QSharedPointer<Queue>) {
         return false;
     };
@@ -26,11 +26,14 @@
 #include "abstractscraper.h"
 
 #include "gameentry.h"
+#include "httpcache.h"
+#include "netarchive.h"
 #include "nametools.h"
 #include "platform.h"
 #include "strtools.h"
 
 #include <QDomDocument>
+#include <QFile>
 #include <QRegularExpression>
 
 AbstractScraper::AbstractScraper(Settings *config,
@@ -39,6 +42,27 @@ AbstractScraper::AbstractScraper(Settings *config,
     : config(config), type(type) {
     netComm = new NetComm(manager);
     connect(netComm, &NetComm::dataReady, &q, &QEventLoop::quit);
+    NetComm::Timeouts timeouts;
+    timeouts.connect = config->connectTimeout;
+    timeouts.firstByte = config->firstByteTimeout;
+    timeouts.total = config->totalTimeout;
+    netComm->setTimeouts(timeouts);
+    if (!config->replayFrom.isEmpty()) {
+        netComm->setArchive(QSharedPointer<NetArchive>(
+            new NetArchive(config->replayFrom, NetArchive::REPLAY,
+                           config->replayLatency)));
+    } else if (!config->recordTo.isEmpty()) {
+        netComm->setArchive(QSharedPointer<NetArchive>(
+            new NetArchive(config->recordTo, NetArchive::RECORD)));
+        netComm->addSecret(config->password.toUtf8());
+    } else if (config->httpCache && !config->cacheFolder.isEmpty()) {
+        // Not with a recording, which should have every request go to the
+        // network. A refresh asks the servers about everything, but only what
+        // has changed is downloaded again
+        netComm->setHttpCache(QSharedPointer<HttpCache>(
+            new HttpCache(config->cacheFolder + "/http",
+                          config->httpCacheTtl * 60 * 60, config->refresh)));
+    }
 }
 
 AbstractScraper::~AbstractScraper() { netComm->deleteLater(); }
@@ -90,6 +114,9 @@ void AbstractScraper::getGameData(GameEntry &game) {
 void AbstractScraper::getTitle(GameEntry &) {}
 
 void AbstractScraper::populateGameEntry(GameEntry &game) {
+    if (mediaParallel > 1) {
+        prefetchMedia(game);
+    }
     for (int t : fetchOrder) {
         switch (t) {
         case TITLE:
@@ -157,6 +184,72 @@ void AbstractScraper::populateGameEntry(GameEntry &game) {
         default:;
         }
     }
+    netComm->clearPrefetched();
+}
+
+bool AbstractScraper::mediaEnabled(const int type) {
+    switch (type) {
+    case COVER:
+        return config->cacheCovers;
+    case SCREENSHOT:
+        return config->cacheScreenshots;
+    case WHEEL:
+        return config->cacheWheels;
+    case MARQUEE:
+        return config->cacheMarquees;
+    case TEXTURE:
+        return config->cacheTextures;
+    case VIDEO:
+        return config->videos;
+    case MANUAL:
+        return config->manuals;
+    default:
+        return false;
+    }
+}
+
+// Downloads the media of 'game' concurrently, so a game takes about as long as
+// its slowest download instead of the sum of all of them. The get*() calls in
+// populateGameEntry() are then answered from these downloads
+void AbstractScraper::prefetchMedia(const GameEntry &game) {
+    QStringList urls;
+    for (int t : fetchOrder) {
+        // Videos and manuals are streamed to disk instead, see
+        // downloadToCache()
+        if (t != VIDEO && t != MANUAL && mediaEnabled(t)) {
+            urls.append(getMediaUrl(t, game));
+        }
+    }
+    netComm->prefetch(urls, mediaParallel);
+}
+
+QString AbstractScraper::getMediaUrl(const int, const GameEntry &) {
+    return QString();
+}
+
+// Returns the url the nom based get*() methods would request for 'pre' and
+// 'post', without digesting 'data'
+QString AbstractScraper::peekUrl(const QList<QString> &pre,
+                                 const QString &post) {
+    if (pre.isEmpty()) {
+        return QString();
+    }
+    for (const auto &nom : pre) {
+        if (!checkNom(nom)) {
+            return QString();
+        }
+    }
+    const QByteArray fullData = data;
+    for (const auto &nom : pre) {
+        nomNom(nom);
+    }
+    QString url =
+        data.left(data.indexOf(post.toUtf8())).replace("&amp;", "&");
+    data = fullData;
+    if (url.left(4) != "http") {
+        url.prepend(baseUrl + (url.left(1) == "/" ? "" : "/"));
+    }
+    return url;
 }
 
 // TODO: openretro and worldofspectrum
@@ -457,14 +550,40 @@ void AbstractScraper::getVideo(GameEntry &game) {
     if (videoUrl.left(4) != "http") {
         videoUrl.prepend(baseUrl + (videoUrl.left(1) == "/" ? "" : "/"));
     }
-    netComm->request(videoUrl);
-    q.exec();
-    if (netComm->getError() == QNetworkReply::NoError) {
-        game.videoData = netComm->getData();
+    NetComm::Download download;
+    if (downloadToCache(videoUrl, "video", QByteArray(), game, download)) {
         game.videoFormat = videoUrl.right(3);
     }
 }
 
+bool AbstractScraper::downloadToCache(const QString &url, const QString &type,
+                                      const QByteArray &contentType,
+                                      GameEntry &game,
+                                      NetComm::Download &download) {
+    const bool isVideoType = type == "video";
+    QString &file = isVideoType ? game.videoDownload : game.manualDownload;
+    // From an earlier attempt
+    if (!file.isEmpty()) {
+        QFile::remove(file);
+        file = "";
+    }
+    if (!netComm->download(url, config->cacheFolder + "/downloads",
+                           contentType,
+                           isVideoType ? config->videoSizeLimit : 0,
+                           download)) {
+        return false;
+    }
+    file = download.fileName;
+    if (isVideoType) {
+        game.videoSize = download.size;
+        game.videoChecksum = download.checksum;
+    } else {
+        game.manualSize = download.size;
+        game.manualChecksum = download.checksum;
+    }
+    return true;
+}
+
 void AbstractScraper::nomNom(const QString nom, bool including) {
     data.remove(0, data.indexOf(nom.toUtf8()) + (including ? nom.length() : 0));
 }
@@ -84,6 +84,16 @@ protected:
     virtual void getVideo(GameEntry &game);
     virtual void getManual(GameEntry &game) { (void)game; };
 
+    // First url the get*() method of media 'type' will request, used to
+    // download all media of a game at once when 'mediaParallel' is above 1
+    virtual QString getMediaUrl(const int type, const GameEntry &game);
+    QString peekUrl(const QList<QString> &pre, const QString &post);
+    // Streams a video or manual straight to the cache folder, see
+    // NetComm::download()
+    bool downloadToCache(const QString &url, const QString &type,
+                         const QByteArray &contentType, GameEntry &game,
+                         NetComm::Download &download);
+
     virtual void nomNom(const QString nom, bool including = true);
     bool checkNom(const QString nom);
 
@@ -96,6 +106,9 @@ protected:
     MatchType type = ABSTRACT;
 
     QList<int> fetchOrder;
+    // Media downloads of a game that may run at the same time. Only raise
+    // this for sources without a strict request limit
+    int mediaParallel = 1;
 
     QByteArray data;
 
@@ -150,6 +163,8 @@ protected:
 
 private:
     QString lookupArcadeTitle(const QString &baseName);
+    bool mediaEnabled(const int type);
+    void prefetchMedia(const GameEntry &game);
 #ifndef TESTING
     void detectRegionFromFilename(const QFileInfo &info);
 #endif
@@ -32,6 +32,8 @@
 ArcadeDB::ArcadeDB(Settings *config, QSharedPointer<NetManager> manager)
     : AbstractScraper(config, manager, MatchType::MATCH_ONE) {
     baseUrl = "http://adb.arcadeitalia.net";
+    // Don't change! ArcadeDB asked for a single connection at a time
+    mediaParallel = 1;
 
     searchUrlPre =
         "http://adb.arcadeitalia.net/"
@@ -167,14 +169,33 @@ void ArcadeDB::getVideo(GameEntry &game) {
         jsonObj.value("url_video_shortplay").toString().isEmpty()) {
         return;
     }
-    netComm->request(jsonObj.value("url_video_shortplay").toString());
-    q.exec();
-    game.videoData = netComm->getData();
-    if (netComm->getError() == QNetworkReply::NoError &&
-        game.videoData.length() > 4096) {
+    NetComm::Download download;
+    if (downloadToCache(jsonObj.value("url_video_shortplay").toString(),
+                        "video", QByteArray(), game, download) &&
+        download.size > 4096) {
         game.videoFormat = "mp4";
-    } else {
-        game.videoData = QByteArray();
+    }
+}
+
+QString ArcadeDB::getMediaUrl(const int type, const GameEntry &) {
+    switch (type) {
+    case COVER:
+        for (const auto &key : jsonObj.keys()) {
+            if ((key == "url_image_flyer" || key == "url_image_title") &&
+                !jsonObj.value(key).toString().isEmpty()) {
+                return jsonObj.value(key).toString();
+            }
+        }
+        return QString();
+    case SCREENSHOT:
+        return jsonObj.value("url_image_ingame").toString();
+    case WHEEL:
+        return "http://adb.arcadeitalia.net/media/mame.current/decals/" +
+               jsonObj["game_name"].toString() + ".png";
+    case MARQUEE:
+        return jsonObj.value("url_image_marquee").toString();
+    default:
+        return QString();
     }
 }
 
@@ -53,6 +53,7 @@ private:
     void getWheel(GameEntry &game) override;
     void getMarquee(GameEntry &game) override;
     void getVideo(GameEntry &game) override;
+    QString getMediaUrl(const int type, const GameEntry &game) override;
 
     QJsonDocument jsonDoc;
     QJsonObject jsonObj;
@@ -143,7 +143,7 @@ void AttractMode::preserveFromOld(GameEntry &entry) {
     }
 }
 
-void AttractMode::assembleList(QString &finalOutput,
+void AttractMode::assembleList(GameListWriter &finalOutput,
                                QList<GameEntry> &gameEntries) {
     QStringList cols = {
         "#Name",        "Title",        "Emulator",    "CloneOf",    "Year",
@@ -152,8 +152,7 @@ void AttractMode::assembleList(QString &finalOutput,
         "Extra",        "Buttons",      "Series",      "Language",   "Region",
         "Rating"};
 
-    QStringList l;
-    l.append(cols.join(";"));
+    finalOutput.append(cols.join(";") % "\n");
 
     int dots = -1;
     int dotMod = 1 + gameEntries.length() * 0.1;
@@ -189,7 +188,7 @@ void AttractMode::assembleList(QString &finalOutput,
         row.append(""); // Language
         row.append(""); // Region
         row.append(entry.rating);
-        l.append(row.join(";"));
+        finalOutput.append(row.join(";") % "\n");
 
         if (!entry.description.isEmpty() && saveDescFile) {
             QFile descFile(descDir.absolutePath() % "/" % entry.baseName %
@@ -201,7 +200,6 @@ void AttractMode::assembleList(QString &finalOutput,
             }
         }
     }
-    finalOutput = l.join("\n") % "\n";
 }
 
 void AttractMode::checkReqs() {
@@ -39,7 +39,7 @@ public:
     void checkReqs() override;
     bool skipExisting(QList<GameEntry> &gameEntries,
                       QSharedPointer<Queue> queue) override;
-    void assembleList(QString &finalOutput,
+    void assembleList(GameListWriter &finalOutput,
                       QList<GameEntry> &gameEntries) override;
     bool canSkip() override;
     bool loadOldGameList(const QString &gameListFileString) override;
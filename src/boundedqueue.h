@@ -0,0 +1,106 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <deque>
+#include <utility>
+
+/*
+ * Blocking FIFO between two pipeline stages. push() waits while the queue is
+ * full, pop() waits while it is empty. After close() no more items are taken
+ * and pop() returns false once the remaining items have been handed out.
+ */
+template <typename T> class BoundedQueue {
+public:
+    explicit BoundedQueue(int capacity)
+        : capacity(capacity > 0 ? capacity : 1) {}
+
+    bool push(T item) {
+        QMutexLocker locker(&mutex);
+        while (!closed && (int)items.size() >= capacity) {
+            notFull.wait(&mutex);
+        }
+        if (closed) {
+            return false;
+        }
+        items.push_back(std::move(item));
+        notEmpty.wakeOne();
+        return true;
+    }
+
+    bool pop(T &item) {
+        QMutexLocker locker(&mutex);
+        while (!closed && items.empty()) {
+            notEmpty.wait(&mutex);
+        }
+        if (items.empty()) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.wakeOne();
+        return true;
+    }
+
+    // Like pop(), but takes everything queued at once and appends it to
+    // 'batch'
+    bool popAll(std::deque<T> &batch) {
+        QMutexLocker locker(&mutex);
+        while (!closed && items.empty()) {
+            notEmpty.wait(&mutex);
+        }
+        if (items.empty()) {
+            return false;
+        }
+        for (auto &item : items) {
+            batch.push_back(std::move(item));
+        }
+        items.clear();
+        notFull.wakeAll();
+        return true;
+    }
+
+    void close() {
+        QMutexLocker locker(&mutex);
+        closed = true;
+        notEmpty.wakeAll();
+        notFull.wakeAll();
+    }
+
+    // Drops everything not yet taken, used when a run is cut short
+    void clear() {
+        QMutexLocker locker(&mutex);
+        items.clear();
+        notFull.wakeAll();
+    }
+
+private:
+    const int capacity;
+    bool closed = false;
+    std::deque<T> items;
+    QMutex mutex;
+    QWaitCondition notEmpty;
+    QWaitCondition notFull;
+};
+
+#endif // BOUNDEDQUEUE_H
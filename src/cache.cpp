@@ -31,18 +31,46 @@
 #include "queue.h"
 
 #include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QDomDocument>
 #include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QProcess>
+#include <QReadWriteLock>
 #include <QRegularExpression>
+#include <QSaveFile>
 #include <QSet>
 #include <QStringBuilder>
+#include <QThread>
 #include <QXmlStreamAttributes>
 #include <QXmlStreamReader>
+#include <algorithm>
+#include <atomic>
+#include <future>
 #include <iostream>
+#include <vector>
+
+#if defined(Q_OS_WIN)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(Q_OS_LINUX)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#elif defined(Q_OS_MACOS)
+#include <sys/clonefile.h>
+#endif
 
 static inline QStringList txtTypes(bool useGenres = true) {
     QStringList txtTypes = {"title",     "platform",  "description",
@@ -65,11 +93,38 @@ static inline QStringList binTypes(bool withVideo = true,
     return binTypes;
 };
 
+// The permissions QSaveFile gives new files, 0666 less the umask. Downloads
+// are temporary files, which only the owner may read. First called before
+// the scraper threads start, as the umask can only be read by changing it
+static QFile::Permissions newFilePermissions() {
+    static const QFile::Permissions permissions = []() {
+        QFile::Permissions all = QFile::ReadOwner | QFile::WriteOwner |
+                                 QFile::ReadGroup | QFile::WriteGroup |
+                                 QFile::ReadOther | QFile::WriteOther;
+#if !defined(Q_OS_WIN)
+        const mode_t mask = umask(0);
+        umask(mask);
+        const QList<QPair<mode_t, QFile::Permission>> bits = {
+            {S_IRUSR, QFile::ReadOwner}, {S_IWUSR, QFile::WriteOwner},
+            {S_IRGRP, QFile::ReadGroup}, {S_IWGRP, QFile::WriteGroup},
+            {S_IROTH, QFile::ReadOther}, {S_IWOTH, QFile::WriteOther}};
+        for (const auto &bit : bits) {
+            if (mask & bit.first) {
+                all.setFlag(bit.second, false);
+            }
+        }
+#endif
+        return all;
+    }();
+    return permissions;
+}
+
 const QStringList Cache::getAllResourceTypes() {
     return txtTypes() + binTypes();
 }
 
-Cache::Cache(const QString &cacheFolder) {
+Cache::Cache(const QString &cacheFolder, const bool binaryDb)
+    : binaryDb(binaryDb) {
     cacheDir.setPath(cacheFolder);
     cacheDir.makeAbsolute();
     qDebug() << "Cache folder:" << cacheDir;
@@ -83,61 +138,177 @@ bool Cache::createFolders(const QString &scraper) {
         }
     }
 
+    // Still single threaded here
+    newFilePermissions();
+
+    // Downloads left behind by a run that was killed midway. Another instance
+    // may be scraping into the same cache, so only those that haven't been
+    // written to for a day
+    QDir downloads(cacheDir.path() + "/downloads");
+    const QDateTime stale = QDateTime::currentDateTime().addDays(-1);
+    for (const auto &info :
+         downloads.entryInfoList({"download-*"}, QDir::Files)) {
+        if (info.lastModified() < stale) {
+            QFile::remove(info.absoluteFilePath());
+        }
+    }
+
     // Copy priorities.xml example file to cache folder if it doesn't already
     // exist
     QFile::copy("cache/priorities.xml.example", prioFilePath());
     return true;
 }
 
-bool Cache::read() {
-    QFile quickIdFile(quickIdFilePath());
-    if (quickIdFile.open(QIODevice::ReadOnly)) {
-        printf("Reading and parsing quick id xml, please wait... ");
-        fflush(stdout);
-        QXmlStreamReader xml(&quickIdFile);
-        while (!xml.atEnd()) {
-            if (xml.readNext() != QXmlStreamReader::StartElement) {
-                continue;
-            }
-            if (xml.name() != "quickid") {
-                continue;
-            }
-            QXmlStreamAttributes attribs = xml.attributes();
-            if (!attribs.hasAttribute("filepath") ||
-                !attribs.hasAttribute("timestamp") ||
-                !attribs.hasAttribute("id")) {
-                continue;
-            }
+static const QDir::Filters mediaFilters =
+    QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot;
+
+// Lists all files below 'folder' and the modification time and number of
+// entries of every folder visited
+static MediaListing listMediaFolder(const QString &folder) {
+    MediaListing listing;
+    QFileInfo folderInfo(folder);
+    if (!folderInfo.isDir()) {
+        return listing;
+    }
+    listing.folders[folderInfo.absoluteFilePath()] =
+        folderInfo.lastModified().toMSecsSinceEpoch();
+    listing.entries[folderInfo.absoluteFilePath()] = 0;
+    QDirIterator it(folderInfo.absoluteFilePath(), mediaFilters,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        ++listing.entries[info.absolutePath()];
+        if (info.isDir()) {
+            listing.folders[info.absoluteFilePath()] =
+                info.lastModified().toMSecsSinceEpoch();
+            // An empty folder still gets its count of 0
+            listing.entries[info.absoluteFilePath()] += 0;
+        } else {
+            listing.files.insert(info.absoluteFilePath());
+        }
+    }
+    return listing;
+}
 
-            QPair<qint64, QString> pair;
-            pair.first = attribs.value("timestamp").toULongLong();
-            pair.second = attribs.value("id").toString();
-            quickIds[attribs.value("filepath").toString()] = pair;
+bool Cache::readMediaManifest(MediaListing &listing) {
+    QFile manifestFile(manifestFilePath());
+    if (!manifestFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&manifestFile);
+    quint32 version = 0;
+    in >> version;
+    if (version != 2) {
+        return false;
+    }
+    in >> listing.folders >> listing.entries >> listing.files;
+    if (in.status() != QDataStream::Ok || listing.folders.isEmpty()) {
+        return false;
+    }
+    // Adding or removing a file changes the modification time of its folder,
+    // so checking the folders is enough to know the file list is still valid.
+    // That only holds when the times are precise though: on a file system
+    // storing whole seconds a file added in the same second as the listing
+    // goes unnoticed, so the folders are walked again there
+    bool coarseTimes = true;
+    for (auto it = listing.folders.cbegin(); it != listing.folders.cend();
+         ++it) {
+        QFileInfo info(it.key());
+        if (!info.isDir() ||
+            info.lastModified().toMSecsSinceEpoch() != it.value() ||
+            QDir(it.key()).entryList(mediaFilters).size() !=
+                listing.entries.value(it.key(), -1)) {
+            return false;
+        }
+        if (it.value() % 1000 != 0) {
+            coarseTimes = false;
+        }
+    }
+    if (coarseTimes) {
+        return false;
+    }
+    for (auto const &t : binTypes() + QStringList({"blob"})) {
+        const QString typeFolder =
+            QFileInfo(cacheDir.path() % "/" % t % "s").absoluteFilePath();
+        if (QFileInfo(typeFolder).isDir() &&
+            !listing.folders.contains(typeFolder)) {
+            return false;
         }
-        printf("\033[1;32mDone!\033[0m\n");
     }
+    return true;
+}
 
-    QFile cacheFile(dbFilePath());
-    if (cacheFile.open(QIODevice::ReadOnly)) {
-        printf("Building file lookup cache, please wait... ");
-        fflush(stdout);
+void Cache::writeMediaManifest(const MediaListing &listing) {
+    QSaveFile manifestFile(manifestFilePath());
+    if (!manifestFile.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&manifestFile);
+    out << (quint32)2 << listing.folders << listing.entries << listing.files;
+    manifestFile.commit();
+}
 
-        QSet<QString> fileEntries;
-        for (auto const &t : binTypes()) {
-            QDir dir(cacheDir.path() % "/" % t % "s", "*.*", QDir::Name,
-                     QDir::Files);
-            QDirIterator it(dir.absolutePath(),
-                            QDir::Files | QDir::NoDotAndDotDot,
-                            QDirIterator::Subdirectories);
-            while (it.hasNext()) {
-                fileEntries.insert(it.next());
-            }
+// Returns all media files currently in the cache. Each media type folder is
+// walked on its own thread unless the manifest from an earlier run is still
+// valid
+QSet<QString> Cache::getMediaFiles() {
+    MediaListing listing;
+    if (readMediaManifest(listing)) {
+        return listing.files;
+    }
+    listing = MediaListing();
+    std::vector<std::future<MediaListing>> walks;
+    for (auto const &t : binTypes() + QStringList({"blob"})) {
+        walks.push_back(std::async(std::launch::async, listMediaFolder,
+                                   QString(cacheDir.path() % "/" % t % "s")));
+    }
+    for (auto &walk : walks) {
+        MediaListing typeListing = walk.get();
+        listing.files.unite(typeListing.files);
+        for (auto it = typeListing.folders.cbegin();
+             it != typeListing.folders.cend(); ++it) {
+            listing.folders.insert(it.key(), it.value());
+        }
+        for (auto it = typeListing.entries.cbegin();
+             it != typeListing.entries.cend(); ++it) {
+            listing.entries.insert(it.key(), it.value());
+        }
+    }
+    writeMediaManifest(listing);
+    return listing.files;
+}
+
+bool Cache::read() {
+    // The quick ids don't depend on the resources, parse them in parallel
+    std::future<bool> quickIdsRead =
+        std::async(std::launch::async, [this]() {
+            return quickIds.load(quickIdFilePath(), quickIdXmlFilePath());
+        });
+
+    bool dbRead = false;
+    // Prefer 'db.bin' unless 'db.xml' has been written after it
+    QFileInfo binInfo(binFilePath());
+    QFileInfo xmlInfo(dbFilePath());
+    if (binInfo.exists() &&
+        (!xmlInfo.exists() || binInfo.lastModified() >= xmlInfo.lastModified())) {
+        dbRead = readBin();
+        if (!dbRead) {
+            printf("\033[1;33mCouldn't read 'db.bin', falling back to "
+                   "'db.xml'...\033[0m\n");
         }
-        printf("\033[1;32mDone!\033[0m\n");
-        printf("Cached %d files\n\n", fileEntries.count());
+    }
 
+    QFile cacheFile(dbFilePath());
+    if (!dbRead && cacheFile.open(QIODevice::ReadOnly)) {
         printf("Reading and parsing resource cache, please wait... ");
         fflush(stdout);
+        // Look up the media files while db.xml is being parsed. They are only
+        // needed afterwards to drop resources with missing files
+        std::future<QSet<QString>> mediaFilesRead =
+            std::async(std::launch::async, [this]() { return getMediaFiles(); });
+
+        QList<Resource> parsedResources;
         QXmlStreamReader xml(&cacheFile);
         while (!xml.atEnd()) {
             if (xml.readNext() != QXmlStreamReader::StartElement) {
@@ -183,22 +354,213 @@ bool Cache::read() {
                 continue;
             }
             resource.value = xml.readElementText();
+            parsedResources.append(resource);
+        }
+        cacheFile.close();
+
+        const QSet<QString> fileEntries = mediaFilesRead.get();
+        for (const auto &resource : parsedResources) {
             if (binTypes().contains(resource.type) &&
                 !fileEntries.contains(cacheDir.path() % "/" % resource.value)) {
                 printf("Source file '%s' missing, skipping entry...\n",
                        resource.value.toStdString().c_str());
                 continue;
             }
-
-            resources.append(resource);
+            resources[resource.cacheId].append(resource);
         }
-        cacheFile.close();
-        resAtLoad = resources.length();
+        resAtLoad = resourceCount();
         printf("\033[1;32mDone!\033[0m\n");
-        printf("Successfully parsed %d resources!\n\n", resources.length());
-        return true;
+        printf("Successfully parsed %d resources, cached %d files!\n\n",
+               resAtLoad, fileEntries.count());
+        dbRead = true;
     }
-    return false;
+
+    if (quickIdsRead.get()) {
+        printf("Successfully parsed %d quick ids!\n\n", quickIds.size());
+    }
+
+    if (replayJournal() > 0) {
+        dbRead = true;
+    }
+    countBlobRefs();
+    return dbRead;
+}
+
+// Applies the resources added by a previous run that never got to write the
+// full database
+int Cache::replayJournal() {
+    QFile journal(journalFilePath());
+    if (!journal.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    printf("Replaying resource cache journal, please wait... ");
+    fflush(stdout);
+    int replayed = 0;
+    int skipped = 0;
+    while (!journal.atEnd()) {
+        QByteArray line = journal.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        // An interrupted run can leave a truncated last line behind
+        QJsonObject jsonObj = QJsonDocument::fromJson(line).object();
+        if (jsonObj.isEmpty() || !jsonObj.contains("id") ||
+            !jsonObj.contains("type")) {
+            skipped++;
+            continue;
+        }
+        Resource resource;
+        resource.cacheId = jsonObj["id"].toString();
+        resource.type = jsonObj["type"].toString();
+        resource.source = jsonObj["source"].toString();
+        resource.value = jsonObj["value"].toString();
+        resource.timestamp = (qint64)jsonObj["timestamp"].toDouble();
+        if (binTypes().contains(resource.type) &&
+            !QFileInfo::exists(cacheDir.path() % "/" % resource.value)) {
+            skipped++;
+            continue;
+        }
+        loadFromBin(resource.cacheId);
+        QList<Resource> &romResources = resources[resource.cacheId];
+        int idx =
+            indexOfResource(romResources, resource.type, resource.source);
+        if (idx != -1) {
+            // Entries in the journal are always newer
+            romResources.removeAt(idx);
+        } else {
+            addToResCounts(resource.source, resource.type);
+        }
+        romResources.append(resource);
+        replayed++;
+    }
+    journal.close();
+    printf("\033[1;32mDone!\033[0m\n");
+    printf("Successfully replayed %d resources", replayed);
+    if (skipped > 0) {
+        printf(", skipped %d broken entries", skipped);
+    }
+    printf("!\n\n");
+    return replayed;
+}
+
+void Cache::appendJournal(const Resource &resource) {
+    if (!journalFile.isOpen()) {
+        journalFile.setFileName(journalFilePath());
+        if (!journalFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            return;
+        }
+    }
+    QJsonObject jsonObj;
+    jsonObj["id"] = resource.cacheId;
+    jsonObj["type"] = resource.type;
+    jsonObj["source"] = resource.source;
+    jsonObj["timestamp"] = (double)resource.timestamp;
+    jsonObj["value"] = resource.value;
+    journalFile.write(QJsonDocument(jsonObj).toJson(QJsonDocument::Compact) +
+                      "\n");
+    // Hand it to the OS right away so it survives the process being killed.
+    // Getting it onto the disk, to also survive a power loss, costs a lot more
+    // and is only done every few seconds
+    journalFile.flush();
+    if (!journalSynced.isValid() || journalSynced.elapsed() >= 5000) {
+        syncJournal();
+    }
+}
+
+void Cache::syncJournal() {
+    if (!journalFile.isOpen() || !journalFile.flush()) {
+        return;
+    }
+#if defined(Q_OS_WIN)
+    FlushFileBuffers((HANDLE)_get_osfhandle(journalFile.handle()));
+#else
+    ::fsync(journalFile.handle());
+#endif
+    journalSynced.restart();
+}
+
+// The journal is folded into the database once it has grown to a quarter of
+// its size
+bool Cache::needsCompaction() {
+    QFileInfo journalInfo(journalFilePath());
+    if (!journalInfo.exists()) {
+        return false;
+    }
+    QFileInfo dbInfo(binaryDb ? binFilePath() : dbFilePath());
+    const qint64 minSize = 1024 * 1024;
+    return journalInfo.size() > qMax(minSize, dbInfo.size() / 4);
+}
+
+void Cache::clearJournal() {
+    journalFile.close();
+    QFile::remove(journalFilePath());
+}
+
+bool Cache::readBin() {
+    printf("Mapping binary resource cache, please wait... ");
+    fflush(stdout);
+    if (!binDb.open(binFilePath())) {
+        printf("\033[1;31mFailed!\033[0m\n");
+        return false;
+    }
+    const QMap<QPair<QString, QString>, int> typeCounts =
+        binDb.getTypeCounts();
+    for (auto it = typeCounts.cbegin(); it != typeCounts.cend(); ++it) {
+        addToResCounts(it.key().first, it.key().second, it.value());
+    }
+    resAtLoad = binDb.resourceCount();
+    printf("\033[1;32mDone!\033[0m\n");
+    printf("Successfully mapped %d resources!\n\n", resAtLoad);
+    return true;
+}
+
+// True if the resources of this rom still have to be taken from 'db.bin'
+bool Cache::needsBinLoad(const QString &cacheId) {
+    QReadLocker locker(&cacheLock);
+    return binDb.isOpen() && !binLoadedIds.contains(cacheId);
+}
+
+// Moves the resources of a single rom from 'db.bin' into memory. Must be
+// called with 'cacheLock' locked for writing, or before any threads are
+// started
+void Cache::loadFromBin(const QString &cacheId) {
+    if (!binDb.isOpen() || binLoadedIds.contains(cacheId)) {
+        return;
+    }
+    binLoadedIds.insert(cacheId);
+    QList<Resource> romResources = binDb.getResources(cacheId);
+    binLoadedCount += romResources.length();
+    QMutableListIterator<Resource> it(romResources);
+    while (it.hasNext()) {
+        const Resource &res = it.next();
+        if (binTypes().contains(res.type) &&
+            !QFileInfo::exists(cacheDir.path() % "/" % res.value)) {
+            printf("Source file '%s' missing, skipping entry...\n",
+                   res.value.toStdString().c_str());
+            if (isBlob(res.value)) {
+                releaseBlobRef(res.value);
+            }
+            // Counted for the whole file when it was mapped
+            addToResCounts(res.source, res.type, -1);
+            it.remove();
+        }
+    }
+    if (!romResources.isEmpty()) {
+        resources[cacheId] = romResources;
+    }
+}
+
+// Needed by everything that works on the cache as a whole
+void Cache::loadAllFromBin() {
+    if (!binDb.isOpen()) {
+        return;
+    }
+    for (int idx = 0; idx < binDb.idCount(); ++idx) {
+        loadFromBin(binDb.cacheIdAt(idx));
+    }
+    binDb.close();
+    binLoadedIds.clear();
+    binLoadedCount = 0;
 }
 
 void Cache::printPriorities(QString cacheId) {
@@ -337,6 +699,9 @@ void Cache::editResources(QSharedPointer<Queue> queue, const QString &command,
         }
     }
 
+    loadAllFromBin();
+    fullWrite = true;
+
     int queueLength = queue->length();
     printf("\033[1;33mEntering resource cache editing mode! This mode allows "
            "you to edit textual resources for your files. To add media "
@@ -346,8 +711,8 @@ void Cache::editResources(QSharedPointer<Queue> queue, const QString &command,
            "'--startat' and '--endat' command line options to narrow down the "
            "span of the roms you wish to edit. Otherwise Skyscraper will edit "
            "ALL files found in the input folder one by one.\033[0m\n\n");
-    while (queue->hasEntry()) {
-        QFileInfo info = queue->takeEntry();
+    QFileInfo info;
+    while (queue->takeEntry(info)) {
         QString cacheId = getQuickId(info);
         if (cacheId.isEmpty()) {
             cacheId = NameTools::getCacheId(info);
@@ -358,7 +723,7 @@ void Cache::editResources(QSharedPointer<Queue> queue, const QString &command,
         while (!doneEdit) {
             printf("\033[0;32m#%d/%d\033[0m \033[1;33m\nCURRENT FILE: "
                    "\033[0m\033[1;32m%s\033[0m\033[1;33m\033[0m\n",
-                   queueLength - queue->length(), queueLength,
+                   queueLength - queue->remaining(), queueLength,
                    info.fileName().toStdString().c_str());
             std::string userInput = "";
             if (command.isEmpty()) {
@@ -406,15 +771,12 @@ void Cache::editResources(QSharedPointer<Queue> queue, const QString &command,
             } else if (userInput == "S") {
                 printf("\033[1;34mResources connected to this rom:\033[0m\n");
                 bool found = false;
-                for (const auto &res : resources) {
-                    if (res.cacheId == cacheId) {
-                        printf(
-                            "\033[1;33m%s\033[0m (%s): '\033[1;32m%s\033[0m'\n",
-                            res.type.toStdString().c_str(),
-                            res.source.toStdString().c_str(),
-                            res.value.toStdString().c_str());
-                        found = true;
-                    }
+                for (const auto &res : resources.value(cacheId)) {
+                    printf("\033[1;33m%s\033[0m (%s): '\033[1;32m%s\033[0m'\n",
+                           res.type.toStdString().c_str(),
+                           res.source.toStdString().c_str(),
+                           res.value.toStdString().c_str());
+                    found = true;
                 }
                 if (!found)
                     printf("None\n");
@@ -602,17 +964,14 @@ void Cache::editResources(QSharedPointer<Queue> queue, const QString &command,
                                    .hasMatch()) {
                         newRes.value = value;
                         bool updated = false;
-                        QMutableListIterator<Resource> it(resources);
-                        while (it.hasNext()) {
-                            Resource res = it.next();
-                            if (res.cacheId == newRes.cacheId &&
-                                res.type == newRes.type &&
-                                res.source == newRes.source) {
-                                it.remove();
-                                updated = true;
-                            }
+                        QList<Resource> &romResources = resources[cacheId];
+                        int idx;
+                        while ((idx = indexOfResource(romResources, newRes.type,
+                                                      newRes.source)) != -1) {
+                            romResources.removeAt(idx);
+                            updated = true;
                         }
-                        resources.append(newRes);
+                        romResources.append(newRes);
                         if (updated) {
                             printf(">>> Updated existing ");
                         } else {
@@ -632,16 +991,18 @@ void Cache::editResources(QSharedPointer<Queue> queue, const QString &command,
                 QList<int> resIds;
                 printf("\033[1;34mWhich resource id would you like to "
                        "remove?\033[0m (Enter to cancel)\n");
-                for (auto res : resources) {
-                    if (res.cacheId == cacheId &&
-                        !binTypes().contains(res.type)) {
+                const QList<Resource> romResources = resources.value(cacheId);
+                for (int idx = 0; idx < romResources.length(); ++idx) {
+                    const Resource &res = romResources.at(idx);
+                    if (!binTypes().contains(res.type)) {
                         printf(
                             "\033[1;33m%4d\033[0m) \033[1;33m%s\033[0m (%s): "
                             "'\033[1;32m%s\033[0m'\n",
                             ++b, res.type.toStdString().c_str(),
                             res.source.toStdString().c_str(),
                             res.value.toStdString().c_str());
-                        resIds.append(b - 1);
+                        // Index into the resources of this rom
+                        resIds.append(idx);
                     }
                 }
                 if (resIds.isEmpty()) {
@@ -658,27 +1019,26 @@ void Cache::editResources(QSharedPointer<Queue> queue, const QString &command,
                 } else {
                     int chosen = atoi(typeInput.c_str());
                     if (chosen >= 1 && chosen <= resIds.length()) {
-                        resources.removeAt(resIds.at(
+                        auto romIt = resources.find(cacheId);
+                        romIt.value().removeAt(resIds.at(
                             chosen - 1)); // -1 because lists start at 0
+                        if (romIt.value().isEmpty()) {
+                            resources.erase(romIt);
+                        }
                         printf("<<< Removed resource id %d\n\n", chosen);
                     } else {
                         printf("Incorrect resource id, cancelling...\n\n");
                     }
                 }
             } else if (userInput == "D") {
-                QMutableListIterator<Resource> it(resources);
                 bool found = false;
-                while (it.hasNext()) {
-                    Resource res = it.next();
-                    if (res.cacheId == cacheId) {
-                        printf("<<< Removed \033[1;33m%s\033[0m (%s) with "
-                               "value '\033[1;32m%s\033[0m'\n",
-                               res.type.toStdString().c_str(),
-                               res.source.toStdString().c_str(),
-                               res.value.toStdString().c_str());
-                        it.remove();
-                        found = true;
-                    }
+                for (const auto &res : resources.take(cacheId)) {
+                    printf("<<< Removed \033[1;33m%s\033[0m (%s) with "
+                           "value '\033[1;32m%s\033[0m'\n",
+                           res.type.toStdString().c_str(),
+                           res.source.toStdString().c_str(),
+                           res.value.toStdString().c_str());
+                    found = true;
                 }
                 if (!found)
                     printf("No resources found for this rom...\n");
@@ -687,10 +1047,8 @@ void Cache::editResources(QSharedPointer<Queue> queue, const QString &command,
                 printf("\033[1;34mResources from which module would you like "
                        "to remove?\033[0m (Enter to cancel)\n");
                 QMap<QString, int> modules;
-                for (const auto &res : resources) {
-                    if (res.cacheId == cacheId) {
-                        modules[res.source] += 1;
-                    }
+                for (const auto &res : resources.value(cacheId)) {
+                    modules[res.source] += 1;
                 }
                 QMap<QString, int>::iterator it;
                 for (it = modules.begin(); it != modules.end(); ++it) {
@@ -709,16 +1067,19 @@ void Cache::editResources(QSharedPointer<Queue> queue, const QString &command,
                     printf("Resource removal cancelled...\n\n");
                     continue;
                 } else if (modules.contains(QString(typeInput.c_str()))) {
-                    QMutableListIterator<Resource> it(resources);
+                    auto romIt = resources.find(cacheId);
+                    QMutableListIterator<Resource> it(romIt.value());
                     int removed = 0;
                     while (it.hasNext()) {
                         Resource res = it.next();
-                        if (res.cacheId == cacheId &&
-                            res.source == QString(typeInput.c_str())) {
+                        if (res.source == QString(typeInput.c_str())) {
                             it.remove();
                             removed++;
                         }
                     }
+                    if (romIt.value().isEmpty()) {
+                        resources.erase(romIt);
+                    }
                     printf("<<< Removed %d resource(s) connected to rom from "
                            "module '\033[1;32m%s\033[0m'\n\n",
                            removed, typeInput.c_str());
@@ -731,10 +1092,8 @@ void Cache::editResources(QSharedPointer<Queue> queue, const QString &command,
                 printf("\033[1;34mResources of which type would you like to "
                        "remove?\033[0m (Enter to cancel)\n");
                 QMap<QString, int> types;
-                for (const auto &res : resources) {
-                    if (res.cacheId == cacheId) {
-                        types[res.type] += 1;
-                    }
+                for (const auto &res : resources.value(cacheId)) {
+                    types[res.type] += 1;
                 }
                 QMap<QString, int>::iterator it;
                 for (it = types.begin(); it != types.end(); ++it) {
@@ -753,16 +1112,19 @@ void Cache::editResources(QSharedPointer<Queue> queue, const QString &command,
                     printf("Resource removal cancelled...\n\n");
                     continue;
                 } else if (types.contains(QString(typeInput.c_str()))) {
-                    QMutableListIterator<Resource> it(resources);
+                    auto romIt = resources.find(cacheId);
+                    QMutableListIterator<Resource> it(romIt.value());
                     int removed = 0;
                     while (it.hasNext()) {
                         Resource res = it.next();
-                        if (res.cacheId == cacheId &&
-                            res.type == QString(typeInput.c_str())) {
+                        if (res.type == QString(typeInput.c_str())) {
                             it.remove();
                             removed++;
                         }
                     }
+                    if (romIt.value().isEmpty()) {
+                        resources.erase(romIt);
+                    }
                     printf("<<< Removed %d resource(s) connected to rom of "
                            "type '\033[1;32m%s\033[0m'\n\n",
                            removed, typeInput.c_str());
@@ -775,7 +1137,7 @@ void Cache::editResources(QSharedPointer<Queue> queue, const QString &command,
                 printf("Exiting without saving changes.\n");
                 exit(0);
             } else if (userInput == "q") {
-                queue->clear();
+                queue->clearAll();
                 doneEdit = true;
                 continue;
             }
@@ -784,6 +1146,8 @@ void Cache::editResources(QSharedPointer<Queue> queue, const QString &command,
 }
 
 bool Cache::purgeResources(QString purgeStr) {
+    loadAllFromBin();
+    fullWrite = true;
     purgeStr.replace("purge:", "");
     printf("Purging requested resources from cache, please wait...\n");
 
@@ -804,19 +1168,25 @@ bool Cache::purgeResources(QString purgeStr) {
 
     int purged = 0;
 
-    QMutableListIterator<Resource> it(resources);
-    while (it.hasNext()) {
-        Resource res = it.next();
-        bool remove = false;
-        if (res.source == module || res.type == type) {
-            remove = true;
-        }
-        if (remove) {
-            if (!removeMediaFile(res, "Couldn't purge media file '%s'")) {
-                continue;
+    QMutableHashIterator<QString, QList<Resource>> romIt(resources);
+    while (romIt.hasNext()) {
+        QMutableListIterator<Resource> it(romIt.next().value());
+        while (it.hasNext()) {
+            Resource res = it.next();
+            bool remove = false;
+            if (res.source == module || res.type == type) {
+                remove = true;
+            }
+            if (remove) {
+                if (!removeMediaFile(res, "Couldn't purge media file '%s'")) {
+                    continue;
+                }
+                it.remove();
+                purged++;
             }
-            it.remove();
-            purged++;
+        }
+        if (romIt.value().isEmpty()) {
+            romIt.remove();
         }
     }
     printf("Successfully purged %d resources from the cache.\n", purged);
@@ -838,26 +1208,34 @@ bool Cache::purgeAll(const bool unattend) {
     }
 
     printf("Purging ALL resources for the selected platform, please wait...");
+    loadAllFromBin();
+    fullWrite = true;
 
     int purged = 0;
     int dots = 0;
     // Always make dotMod at least 1 or it will give "floating point exception"
     // when modulo
-    int dotMod = resources.size() * 0.1 + 1;
+    int dotMod = resourceCount() * 0.1 + 1;
 
-    QMutableListIterator<Resource> it(resources);
-    while (it.hasNext()) {
-        if (dots % dotMod == 0) {
-            printf(".");
-            fflush(stdout);
+    QMutableHashIterator<QString, QList<Resource>> romIt(resources);
+    while (romIt.hasNext()) {
+        QMutableListIterator<Resource> it(romIt.next().value());
+        while (it.hasNext()) {
+            if (dots % dotMod == 0) {
+                printf(".");
+                fflush(stdout);
+            }
+            dots++;
+            Resource res = it.next();
+            if (!removeMediaFile(res, "Couldn't purge media file '%s'")) {
+                continue;
+            }
+            it.remove();
+            purged++;
         }
-        dots++;
-        Resource res = it.next();
-        if (!removeMediaFile(res, "Couldn't purge media file '%s'")) {
-            continue;
+        if (romIt.value().isEmpty()) {
+            romIt.remove();
         }
-        it.remove();
-        purged++;
     }
     printf("\033[1;32m Done!\033[0m\n");
     if (purged == 0) {
@@ -895,23 +1273,44 @@ QList<QFileInfo> Cache::getFileInfos(const QString &inputFolder,
     return fileInfos;
 }
 
+// Returns the cache id of each file in 'fileInfos', in the same order. Files
+// with a valid quick id are not read at all, the others are hashed on a pool
+// of threads
 QList<QString> Cache::getCacheIdList(const QList<QFileInfo> &fileInfos) {
-    QList<QString> cacheIdList;
-    int dots = 0;
+    std::vector<QString> cacheIds(fileInfos.size());
+    std::atomic<int> nextIdx(0);
+    std::atomic<int> dots(0);
     // Always make dotMod at least 1 or it will give "floating point exception"
     // when modulo
     int dotMod = fileInfos.size() * 0.1 + 1;
-    for (const auto &info : fileInfos) {
-        if (dots % dotMod == 0) {
-            printf(".");
-            fflush(stdout);
-        }
-        dots++;
-        QString cacheId = getQuickId(info);
-        if (cacheId.isEmpty()) {
-            cacheId = NameTools::getCacheId(info);
-            addQuickId(info, cacheId);
+    auto hashWorker = [&]() {
+        int idx;
+        while ((idx = nextIdx++) < fileInfos.size()) {
+            if (dots++ % dotMod == 0) {
+                printf(".");
+                fflush(stdout);
+            }
+            const QFileInfo &info = fileInfos.at(idx);
+            QString cacheId = getQuickId(info);
+            if (cacheId.isEmpty()) {
+                cacheId = NameTools::getCacheId(info);
+                addQuickId(info, cacheId);
+            }
+            cacheIds[idx] = cacheId;
         }
+    };
+    std::vector<std::future<void>> workers;
+    const int workerCount = qMax(1, QThread::idealThreadCount());
+    for (int a = 0; a < workerCount; ++a) {
+        workers.push_back(std::async(std::launch::async, hashWorker));
+    }
+    for (auto &worker : workers) {
+        worker.get();
+    }
+
+    QList<QString> cacheIdList;
+    cacheIdList.reserve(fileInfos.size());
+    for (const auto &cacheId : cacheIds) {
         cacheIdList.append(cacheId);
     }
     return cacheIdList;
@@ -971,6 +1370,7 @@ void Cache::assembleReport(const Settings &config, const QString filter) {
         }
         printf("\n");
     }
+    loadAllFromBin();
 
     // Create the reports folder
     QDir reportsDir(Config::getSkyFolder(Config::SkyFolderType::REPORT));
@@ -1025,12 +1425,10 @@ void Cache::assembleReport(const Settings &config, const QString filter) {
                 }
                 dots++;
                 bool found = false;
-                for (const auto &res : resources) {
-                    if (res.cacheId == cacheIdList.at(a)) {
-                        if (res.type == resType) {
-                            found = true;
-                            break;
-                        }
+                for (const auto &res : resources.value(cacheIdList.at(a))) {
+                    if (res.type == resType) {
+                        found = true;
+                        break;
                     }
                 }
                 if (!found) {
@@ -1086,21 +1484,21 @@ bool Cache::vacuumResources(const QString inputFolder, const QString filter,
     }
 
     printf("Vacuuming cache, this can take several minutes, please wait...");
+    loadAllFromBin();
+    fullWrite = true;
     QList<QFileInfo> fileInfos = getFileInfos(inputFolder, filter);
     // Clean the quick id's aswell
-    QMap<QString, QPair<qint64, QString>> quickIdsCleaned;
-    for (const auto &info : fileInfos) {
-        QString filePath = info.absoluteFilePath();
-        if (quickIds.contains(filePath)) {
-            quickIdsCleaned[filePath] = quickIds[filePath];
-        }
-    }
-    quickIds = quickIdsCleaned;
-    QList<QString> cacheIdList = getCacheIdList(fileInfos);
+    quickIds.retain(fileInfos);
+    const QList<QString> cacheIdList = getCacheIdList(fileInfos);
     if (cacheIdList.isEmpty()) {
         printf("No cache id's found, something is wrong, cancelling...\n");
         return false;
     }
+#if QT_VERSION >= 0x050e00
+    const QSet<QString> romsetIds(cacheIdList.begin(), cacheIdList.end());
+#else
+    const QSet<QString> romsetIds = cacheIdList.toSet();
+#endif
 
     int vacuumed = 0;
     {
@@ -1109,22 +1507,20 @@ bool Cache::vacuumResources(const QString inputFolder, const QString filter,
         // exception" when modulo
         int dotMod = resources.size() * 0.1 + 1;
 
-        QMutableListIterator<Resource> it(resources);
-        while (it.hasNext()) {
+        QMutableHashIterator<QString, QList<Resource>> romIt(resources);
+        while (romIt.hasNext()) {
             if (dots % dotMod == 0) {
                 printf(".");
                 fflush(stdout);
             }
             dots++;
-            Resource res = it.next();
-            bool remove = true;
-            for (const auto &cacheId : cacheIdList) {
-                if (res.cacheId == cacheId) {
-                    remove = false;
-                    break;
-                }
+            romIt.next();
+            if (romsetIds.contains(romIt.key())) {
+                continue;
             }
-            if (remove) {
+            QMutableListIterator<Resource> it(romIt.value());
+            while (it.hasNext()) {
+                Resource res = it.next();
                 if (!removeMediaFile(res, "Couldn't remove media file '%s'")) {
                     continue;
                 }
@@ -1135,6 +1531,9 @@ bool Cache::vacuumResources(const QString inputFolder, const QString filter,
                 it.remove();
                 vacuumed++;
             }
+            if (romIt.value().isEmpty()) {
+                romIt.remove();
+            }
         }
     }
     printf("\033[1;32m Done!\033[0m\n");
@@ -1233,41 +1632,42 @@ void Cache::showStats(int verbosity) {
     printf("\n");
 }
 
-void Cache::addToResCounts(const QString source, const QString type) {
+void Cache::addToResCounts(const QString source, const QString type,
+                           const int count) {
     if (type == "title") {
-        resCountsMap[source].titles++;
+        resCountsMap[source].titles += count;
     } else if (type == "platform") {
-        resCountsMap[source].platforms++;
+        resCountsMap[source].platforms += count;
     } else if (type == "description") {
-        resCountsMap[source].descriptions++;
+        resCountsMap[source].descriptions += count;
     } else if (type == "publisher") {
-        resCountsMap[source].publishers++;
+        resCountsMap[source].publishers += count;
     } else if (type == "developer") {
-        resCountsMap[source].developers++;
+        resCountsMap[source].developers += count;
     } else if (type == "players") {
-        resCountsMap[source].players++;
+        resCountsMap[source].players += count;
     } else if (type == "ages") {
-        resCountsMap[source].ages++;
+        resCountsMap[source].ages += count;
     } else if (type == "tags") {
-        resCountsMap[source].tags++;
+        resCountsMap[source].tags += count;
     } else if (type == "rating") {
-        resCountsMap[source].ratings++;
+        resCountsMap[source].ratings += count;
     } else if (type == "releasedate") {
-        resCountsMap[source].releaseDates++;
+        resCountsMap[source].releaseDates += count;
     } else if (type == "cover") {
-        resCountsMap[source].covers++;
+        resCountsMap[source].covers += count;
     } else if (type == "screenshot") {
-        resCountsMap[source].screenshots++;
+        resCountsMap[source].screenshots += count;
     } else if (type == "wheel") {
-        resCountsMap[source].wheels++;
+        resCountsMap[source].wheels += count;
     } else if (type == "marquee") {
-        resCountsMap[source].marquees++;
+        resCountsMap[source].marquees += count;
     } else if (type == "texture") {
-        resCountsMap[source].textures++;
+        resCountsMap[source].textures += count;
     } else if (type == "video") {
-        resCountsMap[source].videos++;
+        resCountsMap[source].videos += count;
     } else if (type == "manual") {
-        resCountsMap[source].manuals++;
+        resCountsMap[source].manuals += count;
     }
 }
 
@@ -1323,62 +1723,113 @@ void Cache::readPriorities() {
 }
 
 bool Cache::write(const bool onlyQuickId) {
-    QMutexLocker locker(&cacheMutex);
+    QWriteLocker locker(&cacheLock);
 
-    QFile quickIdFile(quickIdFilePath());
-    if (quickIdFile.open(QIODevice::WriteOnly)) {
-        printf("Writing quick id xml, please wait... ");
+    // Only files that were hashed or moved since the last run change the
+    // quick ids
+    if (quickIds.isDirty()) {
+        printf("Writing quick ids, please wait... ");
         fflush(stdout);
-        QXmlStreamWriter xml(&quickIdFile);
-        xml.setAutoFormatting(true);
-        xml.writeStartDocument();
-        xml.writeStartElement("quickids");
-        for (const auto &key : quickIds.keys()) {
-            xml.writeStartElement("quickid");
-            xml.writeAttribute("filepath", key);
-            xml.writeAttribute("timestamp",
-                               QString::number(quickIds[key].first));
-            xml.writeAttribute("id", quickIds[key].second);
-            xml.writeEndElement();
+        if (quickIds.save(quickIdFilePath(), quickIdXmlFilePath())) {
+            printf("\033[1;32mDone!\033[0m\n");
+        } else {
+            printf("\033[1;31mFailed!\033[0m\n");
         }
-        xml.writeEndElement();
-        xml.writeEndDocument();
-        printf("\033[1;32mDone!\033[0m\n");
-        quickIdFile.close();
-        if (onlyQuickId) {
-            return true;
+    }
+    if (onlyQuickId) {
+        return true;
+    }
+
+    // Rewriting the whole database can be skipped as long as the journal holds
+    // every change and the database is in the configured format
+    QFileInfo dbInfo(binaryDb ? binFilePath() : dbFilePath());
+    QFileInfo otherDbInfo(binaryDb ? dbFilePath() : binFilePath());
+    bool formatChanged =
+        !dbInfo.exists() ||
+        (otherDbInfo.exists() &&
+         otherDbInfo.lastModified() > dbInfo.lastModified());
+    if (!fullWrite && !formatChanged && !needsCompaction()) {
+        if (QFileInfo::exists(journalFilePath())) {
+            syncJournal();
+            printf("Keeping %d new resources in cache journal.\n\n",
+                   resourceCount() - resAtLoad);
         }
+        return true;
+    }
+
+    bool result = binaryDb ? writeBin() : writeXml();
+    if (result) {
+        clearJournal();
+        fullWrite = false;
     }
+    return result;
+}
 
+bool Cache::writeXml() {
+    loadAllFromBin();
     bool result = false;
-    QFile cacheFile(dbFilePath());
+    // Only replaces 'db.xml' once it has been written completely
+    QSaveFile cacheFile(dbFilePath());
     if (cacheFile.open(QIODevice::WriteOnly)) {
+        const int resTotal = resourceCount();
         printf("Writing %d (%d new) resources to cache, please wait... ",
-               resources.length(), resources.length() - resAtLoad);
+               resTotal, resTotal - resAtLoad);
         fflush(stdout);
         QXmlStreamWriter xml(&cacheFile);
         xml.setAutoFormatting(true);
         xml.writeStartDocument();
         xml.writeStartElement("resources");
-        for (const auto &resource : resources) {
-            xml.writeStartElement("resource");
-            xml.writeAttribute("id", resource.cacheId);
-            xml.writeAttribute("type", resource.type);
-            xml.writeAttribute("source", resource.source);
-            xml.writeAttribute("timestamp",
-                               QString::number(resource.timestamp));
-            xml.writeCharacters(resource.value);
-            xml.writeEndElement();
+        // Keep the order of db.xml stable between runs
+        QList<QString> cacheIds = resources.keys();
+        std::sort(cacheIds.begin(), cacheIds.end());
+        for (const auto &cacheId : cacheIds) {
+            for (const auto &resource : resources.value(cacheId)) {
+                xml.writeStartElement("resource");
+                xml.writeAttribute("id", resource.cacheId);
+                xml.writeAttribute("type", resource.type);
+                xml.writeAttribute("source", resource.source);
+                xml.writeAttribute("timestamp",
+                                   QString::number(resource.timestamp));
+                xml.writeCharacters(resource.value);
+                xml.writeEndElement();
+            }
         }
         xml.writeEndElement();
         xml.writeEndDocument();
-        result = true;
-        printf("\033[1;32mDone!\033[0m\n\n");
-        cacheFile.close();
+        result = cacheFile.commit();
+        if (result) {
+            printf("\033[1;32mDone!\033[0m\n\n");
+        } else {
+            printf("\033[1;31mFailed!\033[0m\n\n");
+        }
     }
     return result;
 }
 
+bool Cache::writeBin() {
+    const int resTotal = resourceCount();
+    printf("Writing %d (%d new) resources to binary cache, please wait... ",
+           resTotal, resTotal - resAtLoad);
+    fflush(stdout);
+    // Roms that were never accessed are copied from the old 'db.bin' as is
+    if (!binDb.save(binFilePath(), resources, binLoadedIds)) {
+        printf("\033[1;31mFailed!\033[0m\n\n");
+        return false;
+    }
+    // Continue on the new file, 'resources' still overrides the loaded roms
+    if (binDb.open(binFilePath())) {
+        binLoadedCount = 0;
+        for (const auto &cacheId : binLoadedIds) {
+            binLoadedCount += binDb.resourceCount(cacheId);
+        }
+    } else {
+        binLoadedIds.clear();
+        binLoadedCount = 0;
+    }
+    printf("\033[1;32mDone!\033[0m\n\n");
+    return true;
+}
+
 // This verifies all attached media files and deletes those that have no entry
 // in the cache
 void Cache::validate() {
@@ -1387,10 +1838,13 @@ void Cache::validate() {
 
     printf("Starting resource cache validation run, please wait...\n");
 
-    if (!QFileInfo::exists(dbFilePath())) {
-        printf("'db.xml' not found, cache cleaning cancelled...\n");
+    if (!QFileInfo::exists(dbFilePath()) && !QFileInfo::exists(binFilePath())) {
+        printf("'%s' not found, cache cleaning cancelled...\n",
+               binaryDb ? "db.bin" : "db.xml");
         return;
     }
+    loadAllFromBin();
+    fullWrite = true;
 
     int filesDeleted = 0;
     int filesNoDelete = 0;
@@ -1403,6 +1857,11 @@ void Cache::validate() {
                           QDirIterator::Subdirectories);
         verifyFiles(iter, filesDeleted, filesNoDelete, t);
     }
+    // Blobs may be shared by resources of any media type
+    QDirIterator blobIter(cacheDir.path() % "/blobs",
+                          QDir::Files | QDir::NoDotAndDotDot,
+                          QDirIterator::Subdirectories);
+    verifyFiles(blobIter, filesDeleted, filesNoDelete, "");
 
     if (filesDeleted == 0 && filesNoDelete == 0) {
         printf("No inconsistencies found in the database. :)\n\n");
@@ -1420,11 +1879,14 @@ void Cache::validate() {
 
 void Cache::verifyFiles(QDirIterator &dirIt, int &filesDeleted,
                         int &filesNoDelete, QString resType) {
-    QList<QString> resFileNames;
-    for (const auto &resource : resources) {
-        if (resource.type == resType) {
-            QFileInfo resInfo(cacheDir.path() + "/" + resource.value);
-            resFileNames.append(resInfo.absoluteFilePath());
+    QSet<QString> resFileNames;
+    for (const auto &romResources : resources) {
+        for (const auto &resource : romResources) {
+            if (resource.type == resType ||
+                (resType.isEmpty() && binTypes().contains(resource.type))) {
+                QFileInfo resInfo(cacheDir.path() + "/" + resource.value);
+                resFileNames.insert(resInfo.absoluteFilePath());
+            }
         }
     }
 
@@ -1444,9 +1906,65 @@ void Cache::verifyFiles(QDirIterator &dirIt, int &filesDeleted,
     }
 }
 
+// Shares the data of 'srcFile' with 'tgtFile' on filesystems that support
+// copy-on-write clones (Btrfs, XFS, APFS, ...). Nothing is copied
+static bool reflinkFile(const QString &srcFile, const QString &tgtFile) {
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+    int src = ::open(QFile::encodeName(srcFile).constData(), O_RDONLY);
+    if (src < 0) {
+        return false;
+    }
+    int tgt = ::open(QFile::encodeName(tgtFile).constData(),
+                     O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (tgt < 0) {
+        ::close(src);
+        return false;
+    }
+    bool cloned = ::ioctl(tgt, FICLONE, src) == 0;
+    ::close(tgt);
+    ::close(src);
+    if (!cloned) {
+        QFile::remove(tgtFile);
+    }
+    return cloned;
+#elif defined(Q_OS_MACOS)
+    return ::clonefile(QFile::encodeName(srcFile).constData(),
+                       QFile::encodeName(tgtFile).constData(), 0) == 0;
+#else
+    Q_UNUSED(srcFile);
+    Q_UNUSED(tgtFile);
+    return false;
+#endif
+}
+
+static bool hardlinkFile(const QString &srcFile, const QString &tgtFile) {
+#if defined(Q_OS_WIN)
+    return CreateHardLinkW((LPCWSTR)tgtFile.utf16(), (LPCWSTR)srcFile.utf16(),
+                           NULL);
+#else
+    return ::link(QFile::encodeName(srcFile).constData(),
+                  QFile::encodeName(tgtFile).constData()) == 0;
+#endif
+}
+
+// Tries the cheapest way to get 'srcFile' into 'tgtFile' first
+static bool transferMediaFile(const QString &srcFile, const QString &tgtFile,
+                              const bool hardlink) {
+    QDir().mkpath(QFileInfo(tgtFile).absolutePath());
+    if (reflinkFile(srcFile, tgtFile)) {
+        return true;
+    }
+    if (hardlink && hardlinkFile(srcFile, tgtFile)) {
+        return true;
+    }
+    return QFile::copy(srcFile, tgtFile);
+}
+
 void Cache::merge(Cache &mergeCache, bool overwrite,
-                  const QString &mergeCacheFolder) {
+                  const QString &mergeCacheFolder, const bool hardlink) {
     printf("Merging databases, please wait...\n");
+    loadAllFromBin();
+    fullWrite = true;
     QList<Resource> mergeResources = mergeCache.getResources();
 
     QDir mergeCacheDir(mergeCacheFolder);
@@ -1455,54 +1973,146 @@ void Cache::merge(Cache &mergeCache, bool overwrite,
     int resUpdated = 0;
     int resMerged = 0;
 
+    // First decide which resources get merged. Only the resources of the same
+    // rom need to be looked at for that
+    QList<Resource> accepted;
+    // cacheId + type + source of 'accepted' entries, to resolve duplicates
+    // within the merged cache the same way as if they were merged one by one
+    QHash<QString, int> acceptedIdx;
     for (const auto &mergeResource : mergeResources) {
+        const QString key = mergeResource.cacheId % "/" % mergeResource.type %
+                            "/" % mergeResource.source;
         bool resExists = false;
-        // This type of iterator ensures we can delete items while iterating
-        QMutableListIterator<Resource> it(resources);
-        while (it.hasNext()) {
-            Resource res = it.next();
-            if (res.cacheId == mergeResource.cacheId &&
-                res.type == mergeResource.type &&
-                res.source == mergeResource.source) {
-                if (overwrite) {
-                    if (!removeMediaFile(res,
-                                         "Couldn't remove media file '%s' for "
-                                         "updating")) {
-                        continue;
+        auto acceptedIt = acceptedIdx.find(key);
+        if (acceptedIt != acceptedIdx.end()) {
+            if (overwrite) {
+                // Superseded by this one
+                accepted[acceptedIt.value()].cacheId.clear();
+            } else {
+                resExists = true;
+            }
+        }
+        auto romIt = resources.find(mergeResource.cacheId);
+        if (!resExists && romIt != resources.end()) {
+            // This type of iterator ensures we can delete items while
+            // iterating
+            QMutableListIterator<Resource> it(romIt.value());
+            while (it.hasNext()) {
+                Resource res = it.next();
+                if (res.type == mergeResource.type &&
+                    res.source == mergeResource.source) {
+                    if (overwrite) {
+                        if (!removeMediaFile(res,
+                                             "Couldn't remove media file '%s' "
+                                             "for updating")) {
+                            continue;
+                        }
+                        it.remove();
+                    } else {
+                        resExists = true;
+                        break;
                     }
-                    it.remove();
-                } else {
-                    resExists = true;
-                    break;
                 }
             }
         }
         if (!resExists) {
-            if (binTypes().contains(mergeResource.type)) {
-                const QString absTgtFile =
-                    cacheDir.path() + "/" + mergeResource.value;
-                cacheDir.mkpath(absTgtFile);
-                if (!QFile::copy(mergeCacheDir.path() + "/" +
-                                     mergeResource.value,
-                                 absTgtFile)) {
-                    printf("Couldn't copy media file '%s', skipping...\n",
-                           mergeResource.value.toStdString().c_str());
-                    continue;
-                }
-            }
-            if (overwrite) {
-                resUpdated++;
-            } else {
-                resMerged++;
+            acceptedIdx[key] = accepted.length();
+            accepted.append(mergeResource);
+        }
+    }
+
+    // Then transfer the media files of the accepted resources in parallel.
+    // Blobs can be shared by several resources, but are transferred once
+    QList<QString> transferValues;
+    QHash<QString, int> transferIdx;
+    for (const auto &res : accepted) {
+        if (!res.cacheId.isEmpty() && binTypes().contains(res.type) &&
+            !transferIdx.contains(res.value)) {
+            transferIdx[res.value] = transferValues.length();
+            transferValues.append(res.value);
+        }
+    }
+    std::vector<char> transferred(transferValues.length(), 1);
+    std::atomic<int> nextIdx(0);
+    auto transferWorker = [&]() {
+        int idx;
+        while ((idx = nextIdx++) < transferValues.length()) {
+            const QString &value = transferValues.at(idx);
+            const QString tgtFile = cacheDir.path() + "/" + value;
+            if (isBlob(value) && QFile::exists(tgtFile)) {
+                // Same name means same content
+                continue;
             }
-            resources.append(mergeResource);
+            transferred[idx] = transferMediaFile(
+                mergeCacheDir.path() + "/" + value, tgtFile, hardlink);
         }
+    };
+    std::vector<std::future<void>> workers;
+    const int workerCount = qMax(1, QThread::idealThreadCount());
+    for (int a = 0; a < workerCount; ++a) {
+        workers.push_back(std::async(std::launch::async, transferWorker));
+    }
+    for (auto &worker : workers) {
+        worker.get();
+    }
+
+    for (int idx = 0; idx < accepted.length(); ++idx) {
+        const Resource &mergeResource = accepted.at(idx);
+        if (transferIdx.contains(mergeResource.value) &&
+            !transferred[transferIdx.value(mergeResource.value)]) {
+            printf("Couldn't copy media file '%s', skipping...\n",
+                   mergeResource.value.toStdString().c_str());
+            continue;
+        }
+        if (overwrite) {
+            resUpdated++;
+        } else {
+            resMerged++;
+        }
+        if (mergeResource.cacheId.isEmpty()) {
+            continue;
+        }
+        if (isBlob(mergeResource.value)) {
+            blobRefs[mergeResource.value]++;
+        }
+        resources[mergeResource.cacheId].append(mergeResource);
     }
     printf("Successfully updated %d resource(s) in cache!\n", resUpdated);
     printf("Successfully merged %d new resource(s) into cache!\n\n", resMerged);
 }
 
-QList<Resource> Cache::getResources() { return resources; }
+QList<Resource> Cache::getResources() {
+    loadAllFromBin();
+    QList<Resource> allResources;
+    allResources.reserve(resourceCount());
+    for (const auto &romResources : resources) {
+        allResources.append(romResources);
+    }
+    return allResources;
+}
+
+int Cache::resourceCount() {
+    int count = 0;
+    for (const auto &romResources : resources) {
+        count += romResources.length();
+    }
+    if (binDb.isOpen()) {
+        // Resources of roms that haven't been accessed yet
+        count += binDb.resourceCount() - binLoadedCount;
+    }
+    return count;
+}
+
+int Cache::indexOfResource(const QList<Resource> &romResources,
+                           const QString &type, const QString &source) {
+    for (int idx = 0; idx < romResources.length(); ++idx) {
+        if (romResources.at(idx).type == type &&
+            romResources.at(idx).source == source) {
+            return idx;
+        }
+    }
+    return -1;
+}
 
 void Cache::addResources(GameEntry &entry, const Settings &config,
                          QString &output) {
@@ -1577,8 +2187,11 @@ void Cache::addResources(GameEntry &entry, const Settings &config,
             {"wheel", !entry.wheelData.isEmpty()},
             {"marquee", !entry.marqueeData.isEmpty()},
             {"texture", !entry.textureData.isEmpty()},
-            {"manual", !entry.manualData.isEmpty()},
-            {"video", !entry.videoData.isEmpty() && entry.videoFormat != ""}};
+            {"manual",
+             !entry.manualData.isEmpty() || !entry.manualDownload.isEmpty()},
+            {"video",
+             (!entry.videoData.isEmpty() || !entry.videoDownload.isEmpty()) &&
+                 entry.videoFormat != ""}};
 
         for (auto const &t : binTypes()) {
             if (cacheTypes.value(t)) {
@@ -1596,148 +2209,195 @@ void Cache::addResources(GameEntry &entry, const Settings &config,
 void Cache::addResource(Resource &resource, GameEntry &entry,
                         const QString &cacheAbsolutePath,
                         const Settings &config, QString &output) {
-    QMutexLocker locker(&cacheMutex);
-    bool notFound = true;
-    // This type of iterator ensures we can delete items while iterating
-    QMutableListIterator<Resource> it(resources);
-    while (it.hasNext()) {
-        Resource res = it.next();
-        if (res.cacheId == resource.cacheId && res.type == resource.type &&
-            res.source == resource.source) {
-            if (config.refresh) {
-                it.remove();
-            } else {
-                notFound = false;
-            }
-            break;
+    if (needsBinLoad(resource.cacheId)) {
+        QWriteLocker locker(&cacheLock);
+        loadFromBin(resource.cacheId);
+    }
+    // Claimed before any media is written, a thread losing the race would
+    // otherwise overwrite the file of the winner or leave a stray blob
+    const QString claim =
+        resource.cacheId % "/" % resource.type % "/" % resource.source;
+    {
+        QWriteLocker locker(&cacheLock);
+        if (resourcesAdding.contains(claim) ||
+            (!config.refresh &&
+             indexOfResource(resources.value(resource.cacheId), resource.type,
+                             resource.source) != -1)) {
+            return;
         }
-    }
-
-    if (notFound) {
-        bool okToAppend = true;
-        QString cacheFile = cacheAbsolutePath + "/" + resource.value;
-        if (binTypes(false, false).contains(resource.type)) {
-            QByteArray *imageData = nullptr;
-            if (resource.type == "cover") {
-                imageData = &entry.coverData;
-            } else if (resource.type == "screenshot") {
-                imageData = &entry.screenshotData;
-            } else if (resource.type == "wheel") {
-                imageData = &entry.wheelData;
-            } else if (resource.type == "marquee") {
-                imageData = &entry.marqueeData;
-            } else if (resource.type == "texture") {
-                imageData = &entry.textureData;
-            }
-            if (config.cacheResize) {
-                QImage image;
-                if (imageData->size() > 0 && image.loadFromData(*imageData) &&
-                    !image.isNull()) {
-                    int max = 800;
-                    if (image.width() > max || image.height() > max) {
-                        image = image.scaled(max, max, Qt::KeepAspectRatio,
-                                             Qt::SmoothTransformation);
-                    }
-                    QByteArray resizedData;
-                    QBuffer b(&resizedData);
-                    b.open(QIODevice::WriteOnly);
-                    if ((image.hasAlphaChannel() && hasAlpha(image)) ||
-                        resource.type == "screenshot") {
-                        okToAppend = image.save(&b, "png");
-                    } else {
-                        okToAppend = image.save(&b, "jpg", config.jpgQuality);
-                    }
-                    b.close();
-                    if (imageData->size() > resizedData.size()) {
-                        if (config.verbosity >= 3) {
-                            printf("%s: '%d' > '%d', choosing resize for "
-                                   "optimal result!\n",
-                                   resource.type.toStdString().c_str(),
-                                   imageData->size(), resizedData.size());
-                        }
-                        *imageData = resizedData;
-                    }
-                } else {
-                    okToAppend = false;
+        resourcesAdding.insert(claim);
+    }
+
+    // Resizing, writing and converting media happens without holding the
+    // lock, only the resource itself is added under it
+    bool okToAppend = true;
+    // Known already for media streamed to disk
+    QString checksum;
+    QString cacheFile = cacheAbsolutePath + "/" + resource.value;
+    if (binTypes(false, false).contains(resource.type)) {
+        QByteArray *imageData = nullptr;
+        if (resource.type == "cover") {
+            imageData = &entry.coverData;
+        } else if (resource.type == "screenshot") {
+            imageData = &entry.screenshotData;
+        } else if (resource.type == "wheel") {
+            imageData = &entry.wheelData;
+        } else if (resource.type == "marquee") {
+            imageData = &entry.marqueeData;
+        } else if (resource.type == "texture") {
+            imageData = &entry.textureData;
+        }
+        if (config.cacheResize) {
+            QImage image;
+            if (imageData->size() > 0 && image.loadFromData(*imageData) &&
+                !image.isNull()) {
+                int max = 800;
+                if (image.width() > max || image.height() > max) {
+                    image = image.scaled(max, max, Qt::KeepAspectRatio,
+                                         Qt::SmoothTransformation);
                 }
-            }
-            if (okToAppend) {
-                QFile f(cacheFile);
-                if (f.open(QIODevice::WriteOnly)) {
-                    f.write(*imageData);
-                    f.close();
+                QByteArray resizedData;
+                QBuffer b(&resizedData);
+                b.open(QIODevice::WriteOnly);
+                if ((image.hasAlphaChannel() && hasAlpha(image)) ||
+                    resource.type == "screenshot") {
+                    okToAppend = image.save(&b, "png");
                 } else {
-                    output.append("Error writing file: '" + f.fileName() +
-                                  "' to cache. Please check permissions.");
-                    okToAppend = false;
+                    okToAppend = image.save(&b, "jpg", config.jpgQuality);
                 }
-            } else {
-                // Image was faulty and could not be saved to cache so we clear
-                // the QByteArray data in game entry to make sure we get a "NO"
-                // in the terminal output from scraperworker.cpp.
-                imageData->clear();
-            }
-        } else if (resource.type == "video") {
-            if (entry.videoData.size() <= config.videoSizeLimit) {
-                QFile f(cacheFile);
-                if (f.open(QIODevice::WriteOnly)) {
-                    f.write(entry.videoData);
-                    f.close();
-                    if (!config.videoConvertCommand.isEmpty()) {
-                        output.append("Video conversion: ");
-                        if (doVideoConvert(resource, cacheFile,
-                                           cacheAbsolutePath, config, output)) {
-                            output.append("\033[1;32mSuccess!\033[0m");
-                        } else {
-                            output.append(
-                                "\033[1;31mFailed!\033[0m (set higher "
-                                "'--verbosity N' level for more info)");
-                            f.remove();
-                            okToAppend = false;
-                        }
+                b.close();
+                if (imageData->size() > resizedData.size()) {
+                    if (config.verbosity >= 3) {
+                        printf("%s: '%d' > '%d', choosing resize for "
+                               "optimal result!\n",
+                               resource.type.toStdString().c_str(),
+                               imageData->size(), resizedData.size());
                     }
-                } else {
-                    output.append("Error writing file: '" + f.fileName() +
-                                  "' to cache. Please check permissions.");
-                    okToAppend = false;
+                    *imageData = resizedData;
                 }
             } else {
-                output.append(
-                    "Video exceeds maximum size of " +
-                    QString::number(config.videoSizeLimit / 1000 / 1000) +
-                    " MB. Adjust this limit with the 'videoSizeLimit' variable "
-                    "in '" %
-                        Config::getSkyFolder(Config::SkyFolderType::CONFIG) %
-                        "/config.ini.'");
                 okToAppend = false;
             }
-        } else if (resource.type == "manual") {
-            QFile f(cacheFile);
-            if (f.open(QIODevice::WriteOnly)) {
-                f.write(entry.manualData);
-                f.close();
-            } else {
+        }
+        if (okToAppend) {
+            // QSaveFile so a thread writing the same file at the same time
+            // can't leave a mix of both behind
+            QSaveFile f(cacheFile);
+            if (!f.open(QIODevice::WriteOnly) ||
+                f.write(*imageData) != imageData->size() || !f.commit()) {
                 output.append("Error writing file: '" + f.fileName() +
                               "' to cache. Please check permissions.");
                 okToAppend = false;
             }
-        }
-
-        if (okToAppend) {
-            if (binTypes(false, false).contains(resource.type)) {
-                // Remove old style cache image if it exists
-                if (QFile::exists(cacheFile + ".png")) {
-                    QFile::remove(cacheFile + ".png");
+        } else {
+            // Image was faulty and could not be saved to cache so we clear
+            // the QByteArray data in game entry to make sure we get a "NO"
+            // in the terminal output from scraperworker.cpp.
+            imageData->clear();
+        }
+    } else if (resource.type == "video") {
+        const qint64 videoSize = entry.videoDownload.isEmpty()
+                                     ? entry.videoData.size()
+                                     : entry.videoSize;
+        if (videoSize <= config.videoSizeLimit) {
+            if (writeMedia(entry.videoData, entry.videoDownload, cacheFile)) {
+                if (!config.videoConvertCommand.isEmpty()) {
+                    output.append("Video conversion: ");
+                    if (doVideoConvert(resource, cacheFile,
+                                       cacheAbsolutePath, config, output)) {
+                        output.append("\033[1;32mSuccess!\033[0m");
+                    } else {
+                        output.append(
+                            "\033[1;31mFailed!\033[0m (set higher "
+                            "'--verbosity N' level for more info)");
+                        QFile::remove(cacheFile);
+                        okToAppend = false;
+                    }
+                } else {
+                    checksum = entry.videoChecksum;
                 }
+            } else {
+                output.append("Error writing file: '" + cacheFile +
+                              "' to cache. Please check permissions.");
+                okToAppend = false;
             }
-            resources.append(resource);
         } else {
-            printf("\033[1;33mWarning! Couldn't add resource to cache. Have "
-                   "you run out of disk space?\n\033[0m");
+            output.append(
+                "Video exceeds maximum size of " +
+                QString::number(config.videoSizeLimit / 1000 / 1000) +
+                " MB. Adjust this limit with the 'videoSizeLimit' variable "
+                "in '" %
+                    Config::getSkyFolder(Config::SkyFolderType::CONFIG) %
+                    "/config.ini.'");
+            okToAppend = false;
+        }
+    } else if (resource.type == "manual") {
+        if (writeMedia(entry.manualData, entry.manualDownload, cacheFile)) {
+            checksum = entry.manualChecksum;
+        } else {
+            output.append("Error writing file: '" + cacheFile +
+                          "' to cache. Please check permissions.");
+            okToAppend = false;
+        }
+    }
+
+    if (okToAppend) {
+        if (binTypes(false, false).contains(resource.type)) {
+            // Remove old style cache image if it exists
+            if (QFile::exists(cacheFile + ".png")) {
+                QFile::remove(cacheFile + ".png");
+            }
+        }
+        // Holds a reference to the blob from here on, if it succeeds
+        if (config.cacheDedupe && binTypes().contains(resource.type) &&
+            !storeAsBlob(resource, checksum)) {
+            output.append("Couldn't move file '" + resource.value +
+                          "' to the blob store, keeping it as is.");
+        }
+        QWriteLocker locker(&cacheLock);
+        resourcesAdding.remove(claim);
+        QList<Resource> &romResources = resources[resource.cacheId];
+        int idx =
+            indexOfResource(romResources, resource.type, resource.source);
+        if (idx != -1) {
+            Resource replaced = romResources.at(idx);
+            if (isBlob(replaced.value) && replaced.value != resource.value) {
+                removeMediaFile(replaced,
+                                "Couldn't remove replaced media file '%s'");
+            } else if (isBlob(replaced.value)) {
+                // The new resource has its own reference to the same blob
+                releaseBlobRef(replaced.value);
+            }
+            romResources.removeAt(idx);
         }
+        romResources.append(resource);
+        appendJournal(resource);
+    } else {
+        QWriteLocker locker(&cacheLock);
+        resourcesAdding.remove(claim);
+        printf("\033[1;33mWarning! Couldn't add resource to cache. Have "
+               "you run out of disk space?\n\033[0m");
     }
 }
 
+// Writes 'data' to 'cacheFile', or moves 'download' there when the media was
+// streamed to disk instead of being loaded
+bool Cache::writeMedia(const QByteArray &data, QString &download,
+                       const QString &cacheFile) {
+    if (!download.isEmpty()) {
+        QFile::remove(cacheFile);
+        if (!QFile::rename(download, cacheFile)) {
+            return false;
+        }
+        download = "";
+        QFile::setPermissions(cacheFile, newFilePermissions());
+        return true;
+    }
+    QSaveFile f(cacheFile);
+    return f.open(QIODevice::WriteOnly) && f.write(data) == data.size() &&
+           f.commit();
+}
+
 bool Cache::doVideoConvert(Resource &resource, QString &cacheFile,
                            const QString &cacheAbsolutePath,
                            const Settings &config, QString &output) {
@@ -1835,51 +2495,37 @@ bool Cache::hasAlpha(const QImage &image) {
 }
 
 void Cache::addQuickId(const QFileInfo &info, const QString &cacheId) {
-    QMutexLocker locker(&quickIdMutex);
-    QPair<qint64, QString> pair; // Quick id pair
-    pair.first = info.lastModified().toMSecsSinceEpoch();
-    pair.second = cacheId;
-    quickIds[info.absoluteFilePath()] = pair;
+    quickIds.add(info, cacheId);
 }
 
-QString Cache::getQuickId(const QFileInfo &info) {
-    QMutexLocker locker(&quickIdMutex);
-    if (quickIds.contains(info.absoluteFilePath()) &&
-        info.lastModified().toMSecsSinceEpoch() <=
-            quickIds[info.absoluteFilePath()].first) {
-        return quickIds[info.absoluteFilePath()].second;
-    }
-    return QString();
-}
+QString Cache::getQuickId(const QFileInfo &info) { return quickIds.get(info); }
 
 bool Cache::hasEntries(const QString &cacheId, const QString scraper) {
-    QMutexLocker locker(&cacheMutex);
-    for (const auto &res : resources) {
-        if (scraper.isEmpty()) {
-            if (res.cacheId == cacheId) {
-                return true;
-            }
-        } else {
-            if (res.cacheId == cacheId && res.source == scraper) {
-                return true;
-            }
+    if (needsBinLoad(cacheId)) {
+        QWriteLocker locker(&cacheLock);
+        loadFromBin(cacheId);
+    }
+    QReadLocker locker(&cacheLock);
+    for (const auto &res : resources.value(cacheId)) {
+        if (scraper.isEmpty() || res.source == scraper) {
+            return true;
         }
     }
     return false;
 }
 
 void Cache::fillBlanks(GameEntry &entry, const QString scraper) {
-    QMutexLocker locker(&cacheMutex);
+    if (needsBinLoad(entry.cacheId)) {
+        QWriteLocker locker(&cacheLock);
+        loadFromBin(entry.cacheId);
+    }
     QList<Resource> matchingResources;
-    // Find all resources related to this particular rom
-    for (const auto &resource : resources) {
-        if (scraper.isEmpty()) {
-            if (entry.cacheId == resource.cacheId) {
-                matchingResources.append(resource);
-            }
-        } else {
-            if (entry.cacheId == resource.cacheId &&
-                resource.source == scraper) {
+    {
+        // Find all resources related to this particular rom. Everything
+        // below works on this copy and doesn't need the lock
+        QReadLocker locker(&cacheLock);
+        for (const auto &resource : resources.value(entry.cacheId)) {
+            if (scraper.isEmpty() || resource.source == scraper) {
                 matchingResources.append(resource);
             }
         }
@@ -1923,47 +2569,59 @@ void Cache::fillBlanks(GameEntry &entry, const QString scraper) {
         }
     }
 
+    QMap<QString, QPair<QString, QString>> mediaFiles; // type, (file, source)
     for (auto const &type : binTypes()) {
         QString result = "";
         QString source = "";
-        QByteArray data;
         if (fillType(type, matchingResources, result, source)) {
-            QFile f(cacheDir.path() + "/" + result);
-            if (f.open(QIODevice::ReadOnly)) {
-                data = f.readAll();
-                f.close();
+            mediaFiles[type] = qMakePair(cacheDir.path() + "/" + result, source);
+        }
+    }
+
+    for (auto it = mediaFiles.cbegin(); it != mediaFiles.cend(); ++it) {
+        const QString &type = it.key();
+        const QString &source = it.value().second;
+        QFileInfo info(it.value().first);
+        if (type == "video" || type == "manual") {
+            // video and manual are not part of artwork.xml / compositor.cpp.
+            // Only keep a handle to the cached file, it is copied to its
+            // destination without ever being loaded
+            if (!info.exists() || info.size() == 0) {
+                continue;
             }
-            if (type == "cover") {
-                entry.coverData = data;
-                entry.coverSrc = source;
-            } else if (type == "screenshot") {
-                entry.screenshotData = data;
-                entry.screenshotSrc = source;
-            } else if (type == "wheel") {
-                entry.wheelData = data;
-                entry.wheelSrc = source;
-            } else if (type == "marquee") {
-                entry.marqueeData = data;
-                entry.marqueeSrc = source;
-            } else if (type == "texture") {
-                entry.textureData = data;
-                entry.textureSrc = source;
-            } else if (type == "video" && !data.isEmpty()) {
-                // video is not part of artwork.xml / compositor.cpp
-                // set filename here
-                entry.videoData = data;
+            if (type == "video") {
                 entry.videoSrc = source;
-                QFileInfo info(f);
                 entry.videoFormat = info.suffix();
                 entry.videoFile = info.absoluteFilePath();
-            } else if (type == "manual" && !data.isEmpty()) {
-                // manual is not part of artwork.xml / compositor.cpp
-                // set filename here
-                entry.manualData = data;
+                entry.videoSize = info.size();
+            } else {
                 entry.manualSrc = source;
-                QFileInfo info(f);
                 entry.manualFile = info.absoluteFilePath();
+                entry.manualSize = info.size();
             }
+            continue;
+        }
+        QByteArray data;
+        QFile f(info.absoluteFilePath());
+        if (f.open(QIODevice::ReadOnly)) {
+            data = f.readAll();
+            f.close();
+        }
+        if (type == "cover") {
+            entry.coverData = data;
+            entry.coverSrc = source;
+        } else if (type == "screenshot") {
+            entry.screenshotData = data;
+            entry.screenshotSrc = source;
+        } else if (type == "wheel") {
+            entry.wheelData = data;
+            entry.wheelSrc = source;
+        } else if (type == "marquee") {
+            entry.marqueeData = data;
+            entry.marqueeSrc = source;
+        } else if (type == "texture") {
+            entry.textureData = data;
+            entry.textureSrc = source;
         }
     }
 }
@@ -2002,11 +2660,97 @@ bool Cache::fillType(const QString &type, QList<Resource> &matchingResources,
 }
 
 bool Cache::removeMediaFile(Resource &res, const char *msg) {
-    if (binTypes().contains(res.type) &&
-        !QFile::remove(cacheDir.path() + "/" + res.value)) {
+    if (!binTypes().contains(res.type)) {
+        return true;
+    }
+    const bool blob = isBlob(res.value);
+    // Other resources still point at this file
+    if (blob && blobRefs.value(res.value) > 1) {
+        blobRefs[res.value]--;
+        return true;
+    }
+    if (!QFile::remove(cacheDir.path() + "/" + res.value)) {
         printf(msg, res.value.toStdString().c_str());
         printf(", skipping...\n");
         return false;
     }
+    if (blob) {
+        blobRefs.remove(res.value);
+    }
     return true;
 }
+
+// Moves the media file of 'resource' into the blob store where it is named by
+// the checksum of its content. If the same content is already stored, the
+// resource simply points at the existing blob
+bool Cache::storeAsBlob(Resource &resource, QString checksum) {
+    const QString cacheFile = cacheDir.path() % "/" % resource.value;
+    if (checksum.isEmpty()) {
+        QFile f(cacheFile);
+        if (!f.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        if (!hash.addData(&f)) {
+            return false;
+        }
+        checksum = hash.result().toHex();
+    }
+    QString blobValue = "blobs/" % checksum.left(2) % "/" % checksum;
+    // Keep the suffix, videos get their format from it
+    const QString suffix = QFileInfo(cacheFile).suffix();
+    if (!suffix.isEmpty()) {
+        blobValue += "." % suffix;
+    }
+    const QString blobFile = cacheDir.path() % "/" % blobValue;
+    // Referenced before the file is looked at, so a thread replacing the last
+    // resource using the blob can't remove it in the meantime
+    {
+        QWriteLocker locker(&cacheLock);
+        blobRefs[blobValue]++;
+    }
+    if (QFile::exists(blobFile)) {
+        QFile::remove(cacheFile);
+    } else {
+        cacheDir.mkpath(QFileInfo(blobFile).absolutePath());
+        if (!QFile::rename(cacheFile, blobFile)) {
+            // Another thread may have stored the same content just now
+            if (!QFile::exists(blobFile)) {
+                QWriteLocker locker(&cacheLock);
+                releaseBlobRef(blobValue);
+                return false;
+            }
+            QFile::remove(cacheFile);
+        }
+    }
+    resource.value = blobValue;
+    return true;
+}
+
+// Resources of cacheIds still in 'db.bin' are counted without decoding them
+void Cache::countBlobRefs() {
+    blobRefs.clear();
+    // Nothing can point at a blob store that doesn't exist
+    if (!QFileInfo::exists(cacheDir.path() + "/blobs")) {
+        return;
+    }
+    if (binDb.isOpen()) {
+        blobRefs = binDb.getBlobRefs(binLoadedIds);
+    }
+    for (const auto &romResources : resources) {
+        for (const auto &res : romResources) {
+            if (isBlob(res.value) && binTypes().contains(res.type)) {
+                blobRefs[res.value]++;
+            }
+        }
+    }
+}
+
+// Must be called with 'cacheLock' locked for writing, or before any other
+// thread uses the cache
+void Cache::releaseBlobRef(const QString &value) {
+    auto it = blobRefs.find(value);
+    if (it != blobRefs.end() && --it.value() <= 0) {
+        blobRefs.erase(it);
+    }
+}
@@ -26,14 +26,19 @@
 #ifndef CACHE_H
 #define CACHE_H
 
+#include "cachebin.h"
 #include "gameentry.h"
 #include "queue.h"
+#include "quickidstore.h"
 #include "settings.h"
 
 #include <QDirIterator>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QMap>
-#include <QMutex>
 #include <QObject>
+#include <QReadWriteLock>
+#include <QSet>
 #include <QSharedPointer>
 #include <QString>
 
@@ -66,9 +71,17 @@ struct ResCounts {
     int manuals;
 };
 
+// Media files found in the cache folders and the modification time and number
+// of entries of every folder that was looked at
+struct MediaListing {
+    QSet<QString> files;
+    QHash<QString, qint64> folders;
+    QHash<QString, int> entries;
+};
+
 class Cache {
 public:
-    Cache(const QString &cacheFolder);
+    Cache(const QString &cacheFolder, const bool binaryDb = false);
 
     static const QStringList getAllResourceTypes();
     bool createFolders(const QString &scraper);
@@ -92,30 +105,74 @@ public:
     void addQuickId(const QFileInfo &info, const QString &cacheId);
     QString getQuickId(const QFileInfo &info);
     void merge(Cache &mergeCache, bool overwrite,
-               const QString &mergeCacheFolder);
+               const QString &mergeCacheFolder, const bool hardlink = false);
     QList<Resource> getResources();
 
 private:
     QDir cacheDir;
-    QMutex cacheMutex;
-    QMutex quickIdMutex;
+    // Guards 'resources' and everything tied to it. Lookups from the scraper
+    // threads only need it for reading and run in parallel
+    QReadWriteLock cacheLock;
+    // Resources a thread is writing the media of, so no other thread works
+    // on the same one at the same time. Guarded by 'cacheLock'
+    QSet<QString> resourcesAdding;
 
     QMap<QString, QList<QString>> prioMap;
 
     QMap<QString, ResCounts> resCountsMap;
 
-    QList<Resource> resources;
-    QMap<QString, QPair<qint64, QString>>
-        quickIds; // filePath, timestamp + cacheId for quick lookup
+    // All resources of a rom grouped by their cacheId. Keeps the per rom
+    // lookups in hasEntries(), fillBlanks() and addResource() independent of
+    // the total size of the cache
+    QHash<QString, QList<Resource>> resources;
+    QuickIdStore quickIds;
 
     int resAtLoad = 0;
 
+    // Mapped 'db.bin'. The resources of a rom are moved into 'resources' the
+    // first time the rom is accessed
+    bool binaryDb = false;
+    CacheBin binDb;
+    QSet<QString> binLoadedIds;
+    int binLoadedCount = 0;
+
+    // Every resource added since the last full write is appended here and
+    // replayed by read(), so nothing gathered is lost if the run is cut short
+    QFile journalFile;
+    // Time since the journal was last synced to the disk
+    QElapsedTimer journalSynced;
+    // Set by changes that can't be expressed in the journal (purges, edits
+    // etc.). These always need a full write
+    bool fullWrite = false;
+
+    // Number of resources pointing at each file in the blob store. Counted
+    // by read() and kept up to date from then on, guarded by 'cacheLock'
+    QHash<QString, int> blobRefs;
+
     QList<QFileInfo> getFileInfos(const QString &inputFolder,
                                   const QString &filter,
                                   const bool subdirs = true);
     QList<QString> getCacheIdList(const QList<QFileInfo> &fileInfos);
 
-    void addToResCounts(const QString source, const QString type);
+    QSet<QString> getMediaFiles();
+    bool readMediaManifest(MediaListing &listing);
+    void writeMediaManifest(const MediaListing &listing);
+    bool readBin();
+    bool writeXml();
+    bool writeBin();
+    bool needsBinLoad(const QString &cacheId);
+    void loadFromBin(const QString &cacheId);
+    void loadAllFromBin();
+    int replayJournal();
+    void appendJournal(const Resource &resource);
+    void syncJournal();
+    bool needsCompaction();
+    void clearJournal();
+    int resourceCount();
+    int indexOfResource(const QList<Resource> &romResources,
+                        const QString &type, const QString &source);
+    void addToResCounts(const QString source, const QString type,
+                        const int count = 1);
     void addResource(Resource &resource, GameEntry &entry,
                      const QString &cacheAbsolutePath, const Settings &config,
                      QString &output);
@@ -123,17 +180,35 @@ private:
                      QString resType);
     void verifyResources(int &resourcesDeleted);
     bool removeMediaFile(Resource &res, const char *msg);
+    bool storeAsBlob(Resource &resource, QString checksum = QString());
+    void countBlobRefs();
+    void releaseBlobRef(const QString &value);
     bool fillType(const QString &type, QList<Resource> &matchingResources,
                   QString &result, QString &source);
+    bool writeMedia(const QByteArray &data, QString &download,
+                    const QString &cacheFile);
     bool doVideoConvert(Resource &resource, QString &cacheFile,
                         const QString &cacheAbsolutePath,
                         const Settings &config, QString &output);
     bool hasAlpha(const QImage &image);
 
     inline const QString quickIdFilePath() {
+        return cacheDir.path() + "/quickid.bin";
+    }
+    inline const QString quickIdXmlFilePath() {
         return cacheDir.path() + "/quickid.xml";
     }
     inline const QString dbFilePath() { return cacheDir.path() + "/db.xml"; }
+    inline const QString binFilePath() { return cacheDir.path() + "/db.bin"; }
+    inline bool isBlob(const QString &value) {
+        return value.startsWith("blobs/");
+    }
+    inline const QString manifestFilePath() {
+        return cacheDir.path() + "/media.manifest";
+    }
+    inline const QString journalFilePath() {
+        return cacheDir.path() + "/db.journal";
+    }
     inline const QString prioFilePath() {
         return cacheDir.path() + "/priorities.xml";
     }
@@ -0,0 +1,341 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include "cachebin.h"
+
+#include "cache.h"
+
+#include <QSaveFile>
+#include <QtEndian>
+#include <cstring>
+
+static const char MAGIC[8] = {'S', 'K', 'Y', 'S', 'C', 'D', 'B', '\0'};
+static const quint32 FORMAT_VERSION = 1;
+static const int HEADER_SIZE = 32;
+static const int INDEX_ENTRY_SIZE = 16;
+static const int RECORD_SIZE = 32;
+
+static inline quint32 getU32(const uchar *p) {
+    return qFromLittleEndian<quint32>(p);
+}
+
+static inline void putU32(QByteArray &buf, quint32 v) {
+    uchar b[4];
+    qToLittleEndian<quint32>(v, b);
+    buf.append(reinterpret_cast<const char *>(b), 4);
+}
+
+static inline void putI64(QByteArray &buf, qint64 v) {
+    uchar b[8];
+    qToLittleEndian<qint64>(v, b);
+    buf.append(reinterpret_cast<const char *>(b), 8);
+}
+
+CacheBin::CacheBin() {}
+
+CacheBin::~CacheBin() { close(); }
+
+bool CacheBin::open(const QString &filePath) {
+    close();
+    binFile.setFileName(filePath);
+    if (!binFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    dataSize = binFile.size();
+    if (dataSize < HEADER_SIZE) {
+        close();
+        return false;
+    }
+    data = binFile.map(0, dataSize);
+    if (data == nullptr || memcmp(data, MAGIC, sizeof(MAGIC)) != 0 ||
+        getU32(data + 8) != FORMAT_VERSION) {
+        printf("\033[1;31mInvalid or unsupported binary cache '%s'\033[0m\n",
+               filePath.toStdString().c_str());
+        close();
+        return false;
+    }
+    ids = getU32(data + 12);
+    records = getU32(data + 16);
+    stringsSize = getU32(data + 20);
+    if ((quint64)HEADER_SIZE + (quint64)ids * INDEX_ENTRY_SIZE +
+            (quint64)records * RECORD_SIZE + stringsSize !=
+        (quint64)dataSize) {
+        printf("\033[1;31mSize of binary cache '%s' doesn't match its "
+               "header\033[0m\n",
+               filePath.toStdString().c_str());
+        close();
+        return false;
+    }
+    return true;
+}
+
+void CacheBin::close() {
+    if (data != nullptr) {
+        binFile.unmap(const_cast<uchar *>(data));
+        data = nullptr;
+    }
+    binFile.close();
+    dataSize = 0;
+    ids = 0;
+    records = 0;
+    stringsSize = 0;
+}
+
+const uchar *CacheBin::indexEntry(int idx) const {
+    return data + HEADER_SIZE + (qint64)idx * INDEX_ENTRY_SIZE;
+}
+
+const uchar *CacheBin::record(quint32 idx) const {
+    return data + HEADER_SIZE + (qint64)ids * INDEX_ENTRY_SIZE +
+           (qint64)idx * RECORD_SIZE;
+}
+
+// 'ref' points to an offset / length pair into the string table
+QByteArray CacheBin::rawString(const uchar *ref) const {
+    quint32 offset = getU32(ref);
+    quint32 length = getU32(ref + 4);
+    if ((quint64)offset + length > stringsSize) {
+        return QByteArray();
+    }
+    const uchar *strings = record(records);
+    return QByteArray::fromRawData(
+        reinterpret_cast<const char *>(strings + offset), length);
+}
+
+int CacheBin::indexOf(const QByteArray &cacheId) const {
+    int lo = 0;
+    int hi = (int)ids - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        QByteArray midId = rawString(indexEntry(mid));
+        if (midId < cacheId) {
+            lo = mid + 1;
+        } else if (cacheId < midId) {
+            hi = mid - 1;
+        } else {
+            return mid;
+        }
+    }
+    return -1;
+}
+
+QString CacheBin::cacheIdAt(int idx) const {
+    if (!isOpen() || idx < 0 || idx >= (int)ids) {
+        return QString();
+    }
+    return QString::fromUtf8(rawString(indexEntry(idx)));
+}
+
+int CacheBin::resourceCount(const QString &cacheId) const {
+    if (!isOpen()) {
+        return 0;
+    }
+    int idx = indexOf(cacheId.toUtf8());
+    return idx == -1 ? 0 : getU32(indexEntry(idx) + 12);
+}
+
+QList<Resource> CacheBin::getResources(const QString &cacheId) const {
+    QList<Resource> romResources;
+    if (!isOpen()) {
+        return romResources;
+    }
+    int idx = indexOf(cacheId.toUtf8());
+    if (idx == -1) {
+        return romResources;
+    }
+    quint32 first = getU32(indexEntry(idx) + 8);
+    quint32 count = getU32(indexEntry(idx) + 12);
+    if ((quint64)first + count > records) {
+        return romResources;
+    }
+    for (quint32 a = first; a < first + count; ++a) {
+        const uchar *rec = record(a);
+        Resource resource;
+        resource.cacheId = cacheId;
+        resource.type = QString::fromUtf8(rawString(rec));
+        resource.source = QString::fromUtf8(rawString(rec + 8));
+        resource.value = QString::fromUtf8(rawString(rec + 16));
+        resource.timestamp = qFromLittleEndian<qint64>(rec + 24);
+        romResources.append(resource);
+    }
+    return romResources;
+}
+
+QMap<QPair<QString, QString>, int> CacheBin::getTypeCounts() const {
+    // Type and source strings are stored only once, so their references can be
+    // counted without decoding them for every record. Remember the first
+    // record of each pair to decode the strings from afterwards
+    QHash<QPair<quint32, quint32>, QPair<int, quint32>> refCounts;
+    for (quint32 a = 0; a < records; ++a) {
+        const uchar *rec = record(a);
+        auto key = qMakePair(getU32(rec + 8), getU32(rec));
+        auto it = refCounts.find(key);
+        if (it == refCounts.end()) {
+            refCounts.insert(key, qMakePair(1, a));
+        } else {
+            it.value().first++;
+        }
+    }
+    QMap<QPair<QString, QString>, int> typeCounts;
+    for (const auto &refCount : refCounts) {
+        const uchar *rec = record(refCount.second);
+        typeCounts[qMakePair(QString::fromUtf8(rawString(rec + 8)),
+                             QString::fromUtf8(rawString(rec)))] +=
+            refCount.first;
+    }
+    return typeCounts;
+}
+
+QHash<QString, int> CacheBin::getBlobRefs(const QSet<QString> &skipIds) const {
+    QHash<QString, int> blobRefs;
+    if (!isOpen()) {
+        return blobRefs;
+    }
+    for (quint32 idx = 0; idx < ids; ++idx) {
+        const uchar *entry = indexEntry(idx);
+        if (!skipIds.isEmpty() &&
+            skipIds.contains(QString::fromUtf8(rawString(entry)))) {
+            continue;
+        }
+        quint32 first = getU32(entry + 8);
+        quint32 count = getU32(entry + 12);
+        if ((quint64)first + count > records) {
+            continue;
+        }
+        for (quint32 a = first; a < first + count; ++a) {
+            // Only the values of blobs are decoded
+            const QByteArray value = rawString(record(a) + 16);
+            if (value.startsWith("blobs/")) {
+                blobRefs[QString::fromUtf8(value)]++;
+            }
+        }
+    }
+    return blobRefs;
+}
+
+bool CacheBin::save(const QString &filePath,
+                    const QHash<QString, QList<Resource>> &resources,
+                    const QSet<QString> &overridden) {
+    struct RawResource {
+        QByteArray type;
+        QByteArray source;
+        QByteArray value;
+        qint64 timestamp;
+    };
+    // QMap keeps the cacheIds sorted bytewise which is what indexOf() expects
+    QMap<QByteArray, QList<RawResource>> entries;
+
+    if (isOpen()) {
+        QSet<QByteArray> skipIds;
+        for (const auto &cacheId : overridden) {
+            skipIds.insert(cacheId.toUtf8());
+        }
+        for (quint32 idx = 0; idx < ids; ++idx) {
+            const uchar *entry = indexEntry(idx);
+            QByteArray cacheId = rawString(entry);
+            if (skipIds.contains(cacheId)) {
+                continue;
+            }
+            quint32 first = getU32(entry + 8);
+            quint32 count = getU32(entry + 12);
+            if ((quint64)first + count > records) {
+                continue;
+            }
+            QList<RawResource> &romResources = entries[cacheId];
+            for (quint32 a = first; a < first + count; ++a) {
+                const uchar *rec = record(a);
+                romResources.append({rawString(rec), rawString(rec + 8),
+                                     rawString(rec + 16),
+                                     qFromLittleEndian<qint64>(rec + 24)});
+            }
+        }
+    }
+    for (auto it = resources.cbegin(); it != resources.cend(); ++it) {
+        if (it.value().isEmpty()) {
+            continue;
+        }
+        QList<RawResource> &romResources = entries[it.key().toUtf8()];
+        romResources.clear();
+        for (const auto &resource : it.value()) {
+            romResources.append({resource.type.toUtf8(),
+                                 resource.source.toUtf8(),
+                                 resource.value.toUtf8(), resource.timestamp});
+        }
+    }
+
+    QByteArray index;
+    QByteArray recs;
+    QByteArray strings;
+    // Types and sources repeat for almost every record, store them only once
+    QHash<QByteArray, quint32> interned;
+    auto addString = [&strings](QByteArray &buf, const QByteArray &str) {
+        putU32(buf, strings.size());
+        putU32(buf, str.size());
+        strings.append(str);
+    };
+    auto addInterned = [&strings, &interned](QByteArray &buf,
+                                             const QByteArray &str) {
+        auto it = interned.constFind(str);
+        quint32 offset;
+        if (it == interned.constEnd()) {
+            offset = strings.size();
+            strings.append(str);
+            interned.insert(str, offset);
+        } else {
+            offset = it.value();
+        }
+        putU32(buf, offset);
+        putU32(buf, str.size());
+    };
+
+    quint32 recordCount = 0;
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+        addString(index, it.key());
+        putU32(index, recordCount);
+        putU32(index, it.value().size());
+        for (const auto &resource : it.value()) {
+            addInterned(recs, resource.type);
+            addInterned(recs, resource.source);
+            addString(recs, resource.value);
+            putI64(recs, resource.timestamp);
+            recordCount++;
+        }
+    }
+    const int idTotal = entries.size();
+    // All data has been copied, the mapping of the old file can go before it
+    // gets replaced
+    entries.clear();
+    close();
+
+    QByteArray header(MAGIC, sizeof(MAGIC));
+    putU32(header, FORMAT_VERSION);
+    putU32(header, idTotal);
+    putU32(header, recordCount);
+    putU32(header, strings.size());
+    putI64(header, 0);
+
+    QSaveFile saveFile(filePath);
+    if (!saveFile.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    saveFile.write(header);
+    saveFile.write(index);
+    saveFile.write(recs);
+    saveFile.write(strings);
+    return saveFile.commit();
+}
@@ -0,0 +1,89 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef CACHEBIN_H
+#define CACHEBIN_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QSet>
+#include <QString>
+
+struct Resource;
+
+/*
+ * Read-only, memory mapped view of the binary resource database 'db.bin'.
+ *
+ * Layout (all integers little endian):
+ *   header   magic "SKYSCDB\0", version, id count, record count, string
+ *            table size, 8 reserved bytes (32 bytes total)
+ *   index    one 16 byte entry per cacheId: id string offset and length, index
+ *            of the first record and record count. Sorted bytewise by cacheId
+ *   records  one 32 byte entry per resource: type, source and value string
+ *            offset and length, timestamp. Grouped by cacheId
+ *   strings  UTF-8 string table referenced by offset into this section
+ *
+ * Nothing is decoded on open(). Resources of a cacheId are only turned into
+ * Resource objects when they are asked for.
+ */
+class CacheBin {
+public:
+    CacheBin();
+    ~CacheBin();
+
+    bool open(const QString &filePath);
+    void close();
+    bool isOpen() const { return data != nullptr; };
+
+    int idCount() const { return ids; };
+    int resourceCount() const { return records; };
+    int resourceCount(const QString &cacheId) const;
+    QString cacheIdAt(int idx) const;
+    QList<Resource> getResources(const QString &cacheId) const;
+    // Resource count per source and type, decoding each distinct string only
+    // once
+    QMap<QPair<QString, QString>, int> getTypeCounts() const;
+    // Number of resources pointing at each file in the blob store, leaving out
+    // the cacheIds in 'skipIds'
+    QHash<QString, int> getBlobRefs(const QSet<QString> &skipIds) const;
+
+    // Writes 'resources' to 'filePath'. Any cacheId of the currently mapped
+    // file not found in 'overridden' is copied over as is. Closes this view
+    bool save(const QString &filePath,
+              const QHash<QString, QList<Resource>> &resources,
+              const QSet<QString> &overridden);
+
+private:
+    QFile binFile;
+    const uchar *data = nullptr;
+    qint64 dataSize = 0;
+    quint32 ids = 0;
+    quint32 records = 0;
+    quint32 stringsSize = 0;
+
+    int indexOf(const QByteArray &cacheId) const;
+    const uchar *indexEntry(int idx) const;
+    const uchar *record(quint32 idx) const;
+    QByteArray rawString(const uchar *ref) const;
+};
+
+#endif // CACHEBIN_H
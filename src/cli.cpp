@@ -128,8 +128,9 @@ void Cli::createParser(QCommandLineParser *parser, QString platforms) {
     QCommandLineOption tOption(
         "t",
         "Number of scraper threads to use. This might change depending on the "
-        "scraping module limits. Default is 4",
-        "1-8", "");
+        "scraping module limits. 'auto' adjusts the number while scraping. "
+        "Default is 4",
+        "1-8|auto", "");
     QCommandLineOption cOption(
         "c",
         "Use this config file to set up Skyscraper. Default: "
@@ -364,6 +365,10 @@ QMap<QString, QString> Cli::getSubCommandOpts(const QString subCmd) {
              "Use filename as game name instead of the returned game title "
              "when generating a game list. Consider using 'nameTemplate' "
              "config.ini option instead."},
+            {"hardlink",
+             "Allows '--cache merge' to hardlink media files into the "
+             "destination cache when they can't be reflinked. Both caches then "
+             "share these files."},
             {"interactive", "Always ask user to choose best returned result "
                             "from the scraping modules."},
             {"nobrackets",
@@ -401,6 +406,9 @@ QMap<QString, QString> Cli::getSubCommandOpts(const QString subCmd) {
              "results of the potential game list generation to the terminal. "
              "Use it to check what and how the data will be combined from "
              "cached resources."},
+            {"quiet",
+             "Only shows a line of progress now and then instead of the "
+             "details of every game when scraping."},
             {"relative",
              "Forces all gamelist paths to be relative to rom location."},
             {"skipexistingcovers",
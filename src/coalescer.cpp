@@ -0,0 +1,127 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include "coalescer.h"
+
+#include <QMutexLocker>
+
+// Long enough for the other roms of a game, which are usually close by in
+// the queue
+constexpr qint64 KEEPTIME = 10 * 60 * 1000;
+constexpr qint64 MAXKEPTSIZE = 64 * 1000 * 1000;
+
+QSharedPointer<Coalescer> Coalescer::get() {
+    static QSharedPointer<Coalescer> coalescer(new Coalescer());
+    return coalescer;
+}
+
+Coalescer::Coalescer() { clock.start(); }
+
+Coalescer::Role Coalescer::join(const QString &key, Response &response,
+                                const bool wait) {
+    QMutexLocker locker(&mutex);
+    while (true) {
+        auto keptIt = kept.find(key);
+        if (keptIt != kept.end()) {
+            if (keptIt.value().until > clock.elapsed()) {
+                response = keptIt.value().response;
+                return SERVED;
+            }
+            keptSize -= keptIt.value().response.data.size();
+            kept.erase(keptIt);
+        }
+
+        auto it = flights.constFind(key);
+        if (it == flights.constEnd()) {
+            flights.insert(key, QSharedPointer<Flight>(new Flight()));
+            return LEADER;
+        }
+        if (!wait) {
+            return BUSY;
+        }
+        QSharedPointer<Flight> flight = it.value();
+        flight->waiting++;
+        while (!flight->done && !flight->abandoned) {
+            landed.wait(&mutex);
+        }
+        flight->waiting--;
+        if (flight->done) {
+            response = flight->response;
+            return SERVED;
+        }
+        // Abandoned, so try to lead it ourselves
+    }
+}
+
+void Coalescer::finish(const QString &key, const Response &response,
+                       const bool keep) {
+    QMutexLocker locker(&mutex);
+    QSharedPointer<Flight> flight = flights.take(key);
+    if (flight) {
+        flight->response = response;
+        flight->done = true;
+    }
+    if (keep) {
+        remember(key, response);
+    }
+    landed.wakeAll();
+}
+
+void Coalescer::abandon(const QString &key) {
+    QMutexLocker locker(&mutex);
+    QSharedPointer<Flight> flight = flights.take(key);
+    if (flight) {
+        flight->abandoned = true;
+    }
+    landed.wakeAll();
+}
+
+bool Coalescer::isAwaited(const QString &key) {
+    QMutexLocker locker(&mutex);
+    auto it = flights.constFind(key);
+    return it != flights.constEnd() && it.value()->waiting > 0;
+}
+
+// Must be called with 'mutex' locked
+void Coalescer::remember(const QString &key, const Response &response) {
+    // A single video could push out everything else
+    if (response.data.size() > MAXKEPTSIZE / 8) {
+        return;
+    }
+    auto it = kept.find(key);
+    if (it != kept.end()) {
+        keptSize -= it.value().response.data.size();
+        kept.erase(it);
+    }
+    kept.insert(key, {response, clock.elapsed() + KEEPTIME});
+    keptOrder.enqueue(key);
+    keptSize += response.data.size();
+    // Oldest first, until it fits and what's left is still to be kept
+    while (!keptOrder.isEmpty()) {
+        auto oldest = kept.find(keptOrder.head());
+        if (oldest != kept.end() && keptSize <= MAXKEPTSIZE &&
+            oldest.value().until > clock.elapsed()) {
+            break;
+        }
+        keptOrder.dequeue();
+        if (oldest != kept.end()) {
+            keptSize -= oldest.value().response.data.size();
+            kept.erase(oldest);
+        }
+    }
+}
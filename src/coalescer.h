@@ -0,0 +1,101 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef COALESCER_H
+#define COALESCER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QNetworkReply>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QString>
+#include <QTemporaryFile>
+#include <QWaitCondition>
+
+/*
+ * Lets the scraper threads share the requests they send. Roms of the same game,
+ * such as the discs of a set or its region variants, often search for the same
+ * game and download the same media at about the same time.
+ *
+ * The first thread asking for a request leads it. Others asking for the same
+ * one meanwhile wait for its response instead of sending their own. Successful
+ * responses are also kept in memory for a while afterwards, up to a total size,
+ * to answer repeats from there.
+ *
+ * Requests are identified by a key the caller makes, which must cover
+ * everything the response depends on. All methods are thread safe.
+ */
+class Coalescer {
+public:
+    struct Response {
+        QByteArray data;
+        QNetworkReply::NetworkError error;
+        QByteArray contentType;
+        QByteArray redirUrl;
+        int httpStatus;
+        // A download handed to the waiting threads. The file is removed once
+        // the last of them lets go of it
+        QSharedPointer<QTemporaryFile> file;
+    };
+    enum Role { LEADER, SERVED, BUSY };
+
+    // The coalescer shared by all threads
+    static QSharedPointer<Coalescer> get();
+
+    Coalescer();
+
+    // SERVED puts the response in 'response'. Without 'wait', BUSY is returned
+    // instead of waiting for another thread. LEADER must be followed by
+    // finish() or abandon() for the same key
+    Role join(const QString &key, Response &response, const bool wait = true);
+    // Passes 'response' to the waiting threads, and keeps it for repeats if
+    // 'keep' is set
+    void finish(const QString &key, const Response &response,
+                const bool keep);
+    // Gives up leading, one of the waiting threads leads the request instead
+    void abandon(const QString &key);
+    // True while other threads wait for the response of 'key'
+    bool isAwaited(const QString &key);
+
+private:
+    struct Flight {
+        bool done = false;
+        bool abandoned = false;
+        int waiting = 0;
+        Response response;
+    };
+    struct Kept {
+        Response response;
+        qint64 until;
+    };
+
+    QMutex mutex;
+    QWaitCondition landed;
+    QHash<QString, QSharedPointer<Flight>> flights;
+    QHash<QString, Kept> kept;
+    QQueue<QString> keptOrder;
+    qint64 keptSize = 0;
+    QElapsedTimer clock;
+
+    void remember(const QString &key, const Response &response);
+};
+
+#endif // COALESCER_H
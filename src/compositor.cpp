@@ -53,6 +53,7 @@
 #include <QSettings>
 #include <QStringBuilder>
 #include <cmath>
+#include <vector>
 
 Compositor::Compositor(Settings *config) { this->config = config; }
 
@@ -302,6 +303,15 @@ void Compositor::saveAll(GameEntry &game, QString completeBaseName) {
         createSubfolder = true;
     }
 
+    struct RenderJob {
+        Layer output;
+        QString filename;
+        bool saved = false;
+    };
+    // Reserved up front, the render threads hold on to the elements
+    std::vector<RenderJob> jobs;
+    jobs.reserve(outputs.getLayers().size());
+
     for (auto &output : outputs.getLayers()) {
         QString filename = fn;
         if (output.resType == "cover") {
@@ -335,59 +345,94 @@ void Compositor::saveAll(GameEntry &game, QString completeBaseName) {
                 game.textureFile = filename;
                 continue;
             }
+        } else {
+            continue;
         }
+        jobs.push_back({output, filename});
+    }
 
-        if (output.resource == "cover") {
-            output.setCanvas(QImage::fromData(game.coverData));
-        } else if (output.resource == "screenshot") {
-            output.setCanvas(QImage::fromData(game.screenshotData));
-        } else if (output.resource == "wheel") {
-            output.setCanvas(QImage::fromData(game.wheelData));
-        } else if (output.resource == "marquee") {
-            output.setCanvas(QImage::fromData(game.marqueeData));
-        } else if (output.resource == "texture") {
-            output.setCanvas(QImage::fromData(game.textureData));
+    // The outputs don't depend on each other, so they are rendered at the
+    // same time when there is a pool to render them on
+    std::vector<std::future<void>> rendering;
+    for (auto &job : jobs) {
+        if (renderPool == nullptr) {
+            job.saved =
+                render(game, job.output, job.filename, createSubfolder);
+            continue;
         }
+        RenderJob *j = &job;
+        rendering.push_back(
+            renderPool->submit([this, &game, j, createSubfolder]() {
+                j->saved =
+                    render(game, j->output, j->filename, createSubfolder);
+            }));
+    }
+    for (auto &r : rendering) {
+        r.wait();
+    }
 
-        if (output.canvas.isNull() && output.hasLayers()) {
-            QImage tmpImage(10, 10, QImage::Format_ARGB32_Premultiplied);
-            output.setCanvas(tmpImage);
+    for (const auto &job : jobs) {
+        if (!job.saved) {
+            continue;
         }
+        if (job.output.resType == "cover") {
+            game.coverFile = job.filename;
+        } else if (job.output.resType == "screenshot") {
+            game.screenshotFile = job.filename;
+        } else if (job.output.resType == "wheel") {
+            game.wheelFile = job.filename;
+        } else if (job.output.resType == "marquee") {
+            game.marqueeFile = job.filename;
+        } else if (job.output.resType == "texture") {
+            game.textureFile = job.filename;
+        }
+    }
+}
 
-        output.premultiply();
-        output.scale();
+// Renders a single output of 'artwork.xml'. Only reads 'game', so several
+// outputs of the same game can be rendered at once
+bool Compositor::render(const GameEntry &game, Layer &output,
+                        const QString &filename, const bool createSubfolder) {
+    if (output.resource == "cover") {
+        output.setCanvas(QImage::fromData(game.coverData));
+    } else if (output.resource == "screenshot") {
+        output.setCanvas(QImage::fromData(game.screenshotData));
+    } else if (output.resource == "wheel") {
+        output.setCanvas(QImage::fromData(game.wheelData));
+    } else if (output.resource == "marquee") {
+        output.setCanvas(QImage::fromData(game.marqueeData));
+    } else if (output.resource == "texture") {
+        output.setCanvas(QImage::fromData(game.textureData));
+    }
 
-        if (output.hasLayers()) {
-            // Reset output.canvas since composite layers exist
-            output.makeTransparent();
-            // Initiate recursive compositing
-            processChildLayers(game, output);
-        }
+    if (output.canvas.isNull() && output.hasLayers()) {
+        QImage tmpImage(10, 10, QImage::Format_ARGB32_Premultiplied);
+        output.setCanvas(tmpImage);
+    }
 
-        if (createSubfolder) {
-            QFileInfo fi = QFileInfo(filename);
-            if (!QDir().mkpath(fi.absolutePath())) {
-                qWarning() << "Path could not be created" << fi.absolutePath()
-                           << " Check file permissions, gamelist binary data "
-                              "maybe incomplete.";
-            }
-        }
+    output.premultiply();
+    output.scale();
 
-        if (output.resType == "cover" && output.save(filename)) {
-            game.coverFile = filename;
-        } else if (output.resType == "screenshot" && output.save(filename)) {
-            game.screenshotFile = filename;
-        } else if (output.resType == "wheel" && output.save(filename)) {
-            game.wheelFile = filename;
-        } else if (output.resType == "marquee" && output.save(filename)) {
-            game.marqueeFile = filename;
-        } else if (output.resType == "texture" && output.save(filename)) {
-            game.textureFile = filename;
+    if (output.hasLayers()) {
+        // Reset output.canvas since composite layers exist
+        output.makeTransparent();
+        // Initiate recursive compositing
+        processChildLayers(game, output);
+    }
+
+    if (createSubfolder) {
+        QFileInfo fi = QFileInfo(filename);
+        if (!QDir().mkpath(fi.absolutePath())) {
+            qWarning() << "Path could not be created" << fi.absolutePath()
+                       << " Check file permissions, gamelist binary data "
+                          "maybe incomplete.";
         }
     }
+
+    return output.save(filename);
 }
 
-void Compositor::processChildLayers(GameEntry &game, Layer &layer) {
+void Compositor::processChildLayers(const GameEntry &game, Layer &layer) {
     for (int a = 0; a < layer.getLayers().length(); ++a) {
         // Create new layer and set canvas to relevant resource (or empty if
         // left out in xml)
@@ -408,7 +453,7 @@ void Compositor::processChildLayers(GameEntry &game, Layer &layer) {
             } else if (thisLayer.resource == "texture") {
                 thisLayer.setCanvas(QImage::fromData(game.textureData));
             } else {
-                thisLayer.setCanvas(config->resources[thisLayer.resource]);
+                thisLayer.setCanvas(config->resources.value(thisLayer.resource));
             }
 
             // If no meaningful canvas could be created, stop processing this
@@ -28,6 +28,7 @@
 
 #include "gameentry.h"
 #include "layer.h"
+#include "renderpool.h"
 #include "settings.h"
 
 #include <QImage>
@@ -40,12 +41,17 @@ public:
     Compositor(Settings *config);
     bool processXml();
     void saveAll(GameEntry &game, QString completeBaseName);
+    // Renders the outputs of a game in parallel on 'pool' from then on
+    void setRenderPool(RenderPool *pool) { renderPool = pool; };
     QString getSubpath(const QString &absPath);
 
 private:
     void addChildLayers(Layer &layer, QXmlStreamReader &xml);
-    void processChildLayers(GameEntry &game, Layer &layer);
+    bool render(const GameEntry &game, Layer &output, const QString &filename,
+                const bool createSubfolder);
+    void processChildLayers(const GameEntry &game, Layer &layer);
     Settings *config;
+    RenderPool *renderPool = nullptr;
     Layer outputs;
 };
 
@@ -144,7 +144,7 @@ bool EmulationStation::existingInGamelist(GameEntry &entry) {
     return false;
 }
 
-void EmulationStation::assembleList(QString &finalOutput,
+void EmulationStation::assembleList(GameListWriter &finalOutput,
                                     QList<GameEntry> &gameEntries) {
     QString extensions = platformFileExtensions();
     // Check if the platform has both cue and bin extensions. Remove
@@ -38,7 +38,7 @@ class EmulationStation : public AbstractFrontend {
 public:
     EmulationStation();
 
-    void assembleList(QString &finalOutput,
+    void assembleList(GameListWriter &finalOutput,
                       QList<GameEntry> &gameEntries) override;
     bool skipExisting(QList<GameEntry> &gameEntries,
                       QSharedPointer<Queue> queue) override;
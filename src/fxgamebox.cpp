@@ -40,7 +40,7 @@ QImage FxGamebox::applyEffect(const QImage &src, const Layer &layer,
     QImage front(src.width() - src.width() * borderFactor, src.height(),
                  QImage::Format_ARGB32_Premultiplied);
     front.fill(Qt::black);
-    QImage overlayFront(config->resources["boxfront.png"]);
+    QImage overlayFront(config->resources.value("boxfront.png"));
     overlayFront =
         overlayFront.scaled(front.width(), front.height(),
                             Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
@@ -52,7 +52,7 @@ QImage FxGamebox::applyEffect(const QImage &src, const Layer &layer,
     painter.drawImage(0, 0, overlayFront);
     painter.end();
 
-    QImage overlaySide(config->resources["boxside.png"]);
+    QImage overlaySide(config->resources.value("boxside.png"));
     overlaySide =
         overlaySide.scaledToHeight(front.height(), Qt::SmoothTransformation);
 
@@ -71,7 +71,7 @@ QImage FxGamebox::applyEffect(const QImage &src, const Layer &layer,
     } else if (layer.resource == "marquee") {
         sideImage = QImage::fromData(game.marqueeData);
     } else {
-        sideImage = QImage(config->resources[layer.resource]);
+        sideImage = QImage(config->resources.value(layer.resource));
     }
     sideImage = sideImage.convertToFormat(QImage::Format_ARGB32_Premultiplied);
 
@@ -34,7 +34,7 @@ QImage FxMask::applyEffect(const QImage &src, const Layer &layer,
                            Settings *config) {
     QImage canvas = src;
 
-    QImage mask(config->resources[layer.resource]);
+    QImage mask(config->resources.value(layer.resource));
     mask = mask.convertToFormat(QImage::Format_ARGB32_Premultiplied);
 
     if (layer.width == -1 && layer.height == -1) {
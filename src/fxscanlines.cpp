@@ -74,13 +74,14 @@ QImage FxScanlines::applyEffect(const QImage &src, const Layer &layer,
     painter.begin(&canvas);
     painter.setOpacity(opacity * 0.01);
     painter.setCompositionMode(layer.mode);
+    const QImage scanlines = config->resources.value(resource);
     painter.drawImage(
         0, 0,
         (scaling != 1.0
-             ? config->resources[resource].scaledToWidth(
-                   (int)((double)config->resources[resource].width() * scaling),
+             ? scanlines.scaledToWidth(
+                   (int)((double)scanlines.width() * scaling),
                    Qt::FastTransformation)
-             : config->resources[resource]));
+             : scanlines));
     painter.end();
 
     return canvas;
@@ -25,6 +25,8 @@
 
 #include "gameentry.h"
 
+#include <QFile>
+
 GameEntry::GameEntry() {}
 
 void GameEntry::calculateCompleteness(bool videoEnabled, bool manualEnabled) {
@@ -82,7 +84,7 @@ void GameEntry::calculateCompleteness(bool videoEnabled, bool manualEnabled) {
     if (videoEnabled && videoFormat.isEmpty()) {
         completeness -= valuePerType;
     }
-    if (manualEnabled && manualData.isEmpty()) {
+    if (manualEnabled && manualData.isEmpty() && manualSize == 0) {
         completeness -= valuePerType;
     }
 }
@@ -95,5 +97,16 @@ void GameEntry::resetMedia() {
     wheelData = QByteArray();
     marqueeData = QByteArray();
     videoData = QByteArray();
+    videoSize = 0;
     manualData = QByteArray();
+    manualSize = 0;
+    // Downloads not moved into the cache are of no use anymore
+    if (!videoDownload.isEmpty()) {
+        QFile::remove(videoDownload);
+        videoDownload = "";
+    }
+    if (!manualDownload.isEmpty()) {
+        QFile::remove(manualDownload);
+        manualDownload = "";
+    }
 }
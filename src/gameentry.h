@@ -60,6 +60,7 @@ public:
     void calculateCompleteness(bool videoEnabled = false,
                                bool manualEnabled = false);
     int getCompleteness() const;
+    // Also removes the files of media streamed to disk
     void resetMedia();
 
     // textual data
@@ -105,9 +106,22 @@ public:
     QByteArray videoData = QByteArray();
     QString videoFile = "";
     QString videoSrc = "";
+    // Size of 'videoFile' when it is taken from the cache. The file is then
+    // copied as is and never loaded into 'videoData'. Also the size of
+    // 'videoDownload'
+    qint64 videoSize = 0;
+    // Set instead of 'videoData' when the video was streamed to this file in
+    // the cache folder. Cache::addResource() moves it into place
+    QString videoDownload = "";
+    QString videoChecksum = ""; // Sha1 of 'videoDownload'
     QByteArray manualData = QByteArray();
     QString manualFile = "";
     QString manualSrc = "";
+    // Same as 'videoSize' but for 'manualFile'
+    qint64 manualSize = 0;
+    // Same as 'videoDownload' and 'videoChecksum'
+    QString manualDownload = "";
+    QString manualChecksum = "";
 
     // internal
     int searchMatch = 0;
@@ -0,0 +1,49 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include "gamelistwriter.h"
+
+constexpr int BLOCKSIZE = 256 * 1024;
+
+GameListWriter::GameListWriter(const QString &fileName) : file(fileName) {}
+
+bool GameListWriter::open() {
+    buffer.reserve(BLOCKSIZE);
+    return file.open(QIODevice::WriteOnly);
+}
+
+void GameListWriter::append(const QString &text) {
+    buffer.append(text.toUtf8());
+    if (buffer.size() >= BLOCKSIZE) {
+        flush();
+    }
+}
+
+bool GameListWriter::commit() {
+    flush();
+    return file.commit();
+}
+
+void GameListWriter::flush() {
+    if (buffer.isEmpty()) {
+        return;
+    }
+    // A failed write is remembered by QSaveFile and makes commit() fail
+    file.write(buffer);
+    buffer.clear();
+}
@@ -0,0 +1,48 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef GAMELISTWRITER_H
+#define GAMELISTWRITER_H
+
+#include <QByteArray>
+#include <QSaveFile>
+#include <QString>
+
+/*
+ * Writes a game list as the frontend assembles it. The text is encoded to
+ * UTF-8 and written out in blocks, so the whole game list is never held in
+ * memory. It goes to a temporary file that only replaces the existing game
+ * list in commit(). A run that is cut short or fails to write leaves the old
+ * game list untouched.
+ */
+class GameListWriter {
+public:
+    explicit GameListWriter(const QString &fileName);
+
+    bool open();
+    void append(const QString &text);
+    bool commit();
+
+private:
+    QSaveFile file;
+    QByteArray buffer;
+
+    void flush();
+};
+
+#endif // GAMELISTWRITER_H
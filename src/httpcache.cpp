@@ -0,0 +1,197 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include "httpcache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringList>
+#include <QUrl>
+#include <QUrlQuery>
+#include <algorithm>
+
+static const quint32 FORMAT_VERSION = 1;
+
+// Query items that identify the user or the application rather than what is
+// asked for. Left out of the key so the cache files aren't named after them
+// and changed credentials don't invalidate it. Bodies are stored as received,
+// see NetComm::setUncachedPaths() for responses holding account data
+static const QStringList CREDENTIALS({"access_token", "api_key", "apikey",
+                                      "client_id", "client_secret", "devid",
+                                      "devpassword", "password", "softname",
+                                      "ssid", "sspassword", "token"});
+
+HttpCache::HttpCache(const QString &folder, const int ttl,
+                     const bool revalidate)
+    : folder(folder), ttl(ttl), revalidate(revalidate) {}
+
+QString HttpCache::key(const QString &url, const QString &postData) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(normalize(url).toString(QUrl::FullyEncoded).toUtf8());
+    hash.addData("\n");
+    hash.addData(postData.toUtf8());
+    return hash.result().toHex();
+}
+
+QUrl HttpCache::normalize(const QString &url) {
+    QUrl normalized(url);
+    normalized.setUserInfo(QString());
+    normalized.setFragment(QString());
+    normalized.setScheme(normalized.scheme().toLower());
+    normalized.setHost(normalized.host().toLower());
+
+    QList<QPair<QString, QString>> items;
+    for (const auto &item : QUrlQuery(normalized).queryItems()) {
+        if (!CREDENTIALS.contains(item.first.toLower())) {
+            items.append(item);
+        }
+    }
+    std::sort(items.begin(), items.end());
+    QUrlQuery query;
+    query.setQueryItems(items);
+    normalized.setQuery(query);
+    return normalized;
+}
+
+QString HttpCache::filePath(const QString &key, const QString &suffix) {
+    // Spread over 256 folders to keep them at a sensible size
+    return folder + "/" + key.left(2) + "/" + key + suffix;
+}
+
+bool HttpCache::load(const QString &key, Entry &entry, const bool withData) {
+    QFile metaFile(filePath(key, ".meta"));
+    if (!metaFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&metaFile);
+    quint32 version = 0;
+    in >> version;
+    if (version != FORMAT_VERSION) {
+        return false;
+    }
+    in >> entry.stored >> entry.httpStatus >> entry.contentType >>
+        entry.redirUrl >> entry.etag >> entry.lastModified;
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+    QFile dataFile(filePath(key, ".data"));
+    if (!withData) {
+        return dataFile.exists();
+    }
+    if (!dataFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    entry.data = dataFile.readAll();
+    return true;
+}
+
+void HttpCache::store(const QString &key, Entry entry,
+                      const QString &dataFile) {
+    entry.stored = QDateTime::currentMSecsSinceEpoch() / 1000;
+    QDir().mkpath(folder + "/" + key.left(2));
+    QSaveFile outFile(filePath(key, ".data"));
+    if (!outFile.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    if (dataFile.isEmpty()) {
+        if (outFile.write(entry.data) != entry.data.size()) {
+            outFile.cancelWriting();
+        }
+    } else {
+        QFile inFile(dataFile);
+        if (!inFile.open(QIODevice::ReadOnly)) {
+            outFile.cancelWriting();
+        }
+        while (inFile.isOpen() && !inFile.atEnd()) {
+            const QByteArray chunk = inFile.read(1024 * 1024);
+            if (chunk.isEmpty() || outFile.write(chunk) != chunk.size()) {
+                outFile.cancelWriting();
+                break;
+            }
+        }
+    }
+    if (!outFile.commit()) {
+        return;
+    }
+    writeMeta(key, entry);
+}
+
+void HttpCache::touch(const QString &key, Entry &entry) {
+    entry.stored = QDateTime::currentMSecsSinceEpoch() / 1000;
+    writeMeta(key, entry);
+}
+
+bool HttpCache::writeMeta(const QString &key, const Entry &entry) {
+    QSaveFile metaFile(filePath(key, ".meta"));
+    if (!metaFile.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream out(&metaFile);
+    out << FORMAT_VERSION << entry.stored << entry.httpStatus
+        << entry.contentType << entry.redirUrl << entry.etag
+        << entry.lastModified;
+    return out.status() == QDataStream::Ok && metaFile.commit();
+}
+
+bool HttpCache::isFresh(const Entry &entry) {
+    return !revalidate &&
+           QDateTime::currentMSecsSinceEpoch() / 1000 - entry.stored < ttl;
+}
+
+void HttpCache::prune(const qint64 maxSize) {
+    struct Stored {
+        QDateTime modified;
+        QString path; // Without the suffix
+        qint64 size;
+    };
+    QList<Stored> stored;
+    qint64 totalSize = 0;
+    // The '.meta' file is rewritten every time the response is confirmed
+    QDirIterator it(folder, {"*.meta"}, QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo metaInfo = it.fileInfo();
+        const QString path =
+            metaInfo.absolutePath() + "/" + metaInfo.completeBaseName();
+        const qint64 size = metaInfo.size() + QFileInfo(path + ".data").size();
+        stored.append({metaInfo.lastModified(), path, size});
+        totalSize += size;
+    }
+    if (totalSize <= maxSize) {
+        return;
+    }
+    std::sort(stored.begin(), stored.end(),
+              [](const Stored &a, const Stored &b) {
+                  return a.modified < b.modified;
+              });
+    for (const auto &entry : stored) {
+        if (totalSize <= maxSize) {
+            break;
+        }
+        QFile::remove(entry.path + ".data");
+        QFile::remove(entry.path + ".meta");
+        totalSize -= entry.size;
+    }
+}
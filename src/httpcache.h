@@ -0,0 +1,85 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef HTTPCACHE_H
+#define HTTPCACHE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QUrl>
+
+/*
+ * Keeps the successful responses of the scraping modules on disk, so running
+ * a module again doesn't download the same data and media once more.
+ *
+ * A response younger than 'ttl' seconds is used as is. An older one is
+ * revalidated with the server using its ETag and Last-Modified headers, which
+ * usually costs a '304 Not Modified' instead of the full transfer.
+ *
+ * Every response is stored as two files named by the hash of its key, a small
+ * '.meta' file with the headers and a '.data' file with the body. Files are
+ * replaced atomically, so the cache may be used by several threads at once.
+ */
+class HttpCache {
+public:
+    struct Entry {
+        QByteArray data;
+        QByteArray contentType;
+        QByteArray redirUrl;
+        int httpStatus = 0;
+        QByteArray etag;
+        QByteArray lastModified;
+        qint64 stored = 0; // Secs since epoch of the last fetch or revalidation
+    };
+
+    // With 'revalidate' set even fresh responses are checked with the server
+    HttpCache(const QString &folder, const int ttl,
+              const bool revalidate = false);
+
+    // Url with credentials and other per user query items removed and the
+    // remaining ones sorted, hashed together with the posted data. Responses
+    // that differ by user must not be cached
+    static QString key(const QString &url, const QString &postData);
+    // 'url' as used by key()
+    static QUrl normalize(const QString &url);
+
+    // Without 'withData' only the headers are read, the body can then be taken
+    // from dataPath()
+    bool load(const QString &key, Entry &entry, const bool withData = true);
+    // The body is taken from 'dataFile' instead of 'entry' when it is set, for
+    // responses streamed to disk
+    void store(const QString &key, Entry entry,
+               const QString &dataFile = QString());
+    // The response was confirmed by the server, restart its 'ttl'
+    void touch(const QString &key, Entry &entry);
+    bool isFresh(const Entry &entry);
+    // Removes the responses fetched or revalidated the longest time ago until
+    // the cache takes up no more than 'maxSize' bytes
+    void prune(const qint64 maxSize);
+    QString dataPath(const QString &key) { return filePath(key, ".data"); };
+
+private:
+    const QString folder;
+    const int ttl;
+    const bool revalidate;
+
+    QString filePath(const QString &key, const QString &suffix);
+    bool writeMeta(const QString &key, const Entry &entry);
+};
+
+#endif // HTTPCACHE_H
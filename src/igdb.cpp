@@ -43,13 +43,12 @@ Igdb::Igdb(Settings *config, QSharedPointer<NetManager> manager)
     headers.append(clientIdHeader);
     headers.append(tokenHeader);
 
-    connect(&limitTimer, &QTimer::timeout, &limiter, &QEventLoop::quit);
-    limitTimer.setInterval(
-        1100); // 1.1 second request limit set a bit above 1.0 as requested by
-               // the good folks at IGDB. Don't change! It will break the module
-               // stability.
-    limitTimer.setSingleShot(false);
-    limitTimer.start();
+    // 1.1 second request limit per thread set a bit above 1.0 as requested
+    // by the good folks at IGDB. Don't change! It will break the module
+    // stability. The threads share the requests
+    const int threads = qMax(1, config->threads);
+    netComm->setRateLimiter(
+        RateLimiter::get("igdb", 1100 / threads, threads));
 
     baseUrl = "https://api.igdb.com/v4";
 
@@ -69,14 +68,14 @@ void Igdb::getSearchResults(QList<GameEntry> &gameEntries, QString searchName,
                             QString platform) {
     // Request list of games but don't allow re-releases ("game.version_parent =
     // null")
-    limiter.exec();
-    netComm->request(baseUrl + "/search/",
-                     "fields "
-                     "game.name,game.platforms.name,game.release_dates.date,"
-                     "game.release_dates.platform; search \"" +
-                         searchName +
-                         "\"; where game != null & game.version_parent = null;",
-                     headers);
+    netComm->request(
+        baseUrl + "/search/",
+        "fields "
+        "game.name,game.platforms.name,game.release_dates.date,"
+        "game.release_dates.platform; search \"" +
+            searchName +
+            "\"; where game != null & game.version_parent = null;",
+        headers);
     q.exec();
     data = netComm->getData();
 
@@ -129,7 +128,6 @@ void Igdb::getSearchResults(QList<GameEntry> &gameEntries, QString searchName,
 }
 
 void Igdb::getGameData(GameEntry &game) {
-    limiter.exec();
     netComm->request(
         baseUrl + "/games/",
         "fields "
@@ -58,12 +58,7 @@ void customMessageHandler(QtMsgType type, const QMessageLogContext &,
         txt += QString("DEBUG: %1").arg(msg);
         break;
     case QtWarningMsg:
-        if (msg.contains("NetManager") ||
-            msg.contains("iCCP: known incorrect sRGB profile")) {
-            /* ugly, needs proper fix: */
-            // NetManager "Cannot create children for a parent that is in a
-            // different thread."
-            /* and */
+        if (msg.contains("iCCP: known incorrect sRGB profile")) {
             // libpng warning: iCCP: known incorrect sRGB profile
             return;
         }
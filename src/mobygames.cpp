@@ -36,10 +36,8 @@
 
 MobyGames::MobyGames(Settings *config, QSharedPointer<NetManager> manager)
     : AbstractScraper(config, manager, MatchType::MATCH_MANY) {
-    connect(&limitTimer, &QTimer::timeout, &limiter, &QEventLoop::quit);
-    limitTimer.setInterval(10000); // 10 second request limit
-    limitTimer.setSingleShot(false);
-    limitTimer.start();
+    netComm->setRateLimiter(
+        RateLimiter::get("mobygames", 10000)); // 10 second request limit
 
     baseUrl = "https://api.mobygames.com";
 
@@ -62,7 +60,6 @@ void MobyGames::getSearchResults(QList<GameEntry> &gameEntries,
     int platformId = getPlatformId(config->platform);
 
     printf("Waiting as advised by MobyGames api restrictions...\n");
-    limiter.exec();
     bool ok;
     int queryGameId = searchName.toInt(&ok);
     QString req;
@@ -135,7 +132,6 @@ void MobyGames::getSearchResults(QList<GameEntry> &gameEntries,
 
 void MobyGames::getGameData(GameEntry &game) {
     printf("Waiting to get game data...\n");
-    limiter.exec();
     netComm->request(game.url);
     q.exec();
     data = netComm->getData();
@@ -298,7 +294,6 @@ void MobyGames::getRating(GameEntry &game) {
 
 void MobyGames::getCover(GameEntry &game) {
     printf("Waiting to get cover data...\n");
-    limiter.exec();
     QString req = QString(
         game.url.left(game.url.indexOf("?api_key=")) + "/covers" +
         game.url.mid(game.url.indexOf("?api_key="),
@@ -377,7 +372,6 @@ void MobyGames::getCover(GameEntry &game) {
 
 void MobyGames::getScreenshot(GameEntry &game) {
     printf("Waiting to get screenshot data...\n");
-    limiter.exec();
     netComm->request(
         game.url.left(game.url.indexOf("?api_key=")) + "/screenshots" +
         game.url.mid(game.url.indexOf("?api_key="),
@@ -0,0 +1,116 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include "netarchive.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+
+static const quint32 FORMAT_VERSION = 1;
+
+// Request headers that carry credentials, recorded without their values
+static const QList<QByteArray> SECRET_HEADERS({"authorization", "client-id",
+                                               "cookie"});
+
+NetArchive::NetArchive(const QString &folder, const Mode mode,
+                       const int latency)
+    : folder(folder), mode(mode), latency(qMax(0, latency)) {}
+
+QString NetArchive::filePath(const QString &key, const QString &suffix) {
+    return folder + "/" + key.left(2) + "/" + key + suffix;
+}
+
+bool NetArchive::load(const QString &key, Entry &entry, const bool withData) {
+    QFile metaFile(filePath(key, ".meta"));
+    if (!metaFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&metaFile);
+    quint32 version = 0;
+    in >> version;
+    if (version != FORMAT_VERSION) {
+        return false;
+    }
+    in >> entry.url >> entry.postData >> entry.headers >> entry.error >>
+        entry.httpStatus >> entry.contentType >> entry.redirUrl >>
+        entry.elapsed;
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+    if (!withData) {
+        return true;
+    }
+    QFile dataFile(dataPath(key));
+    if (!dataFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    entry.data = dataFile.readAll();
+    return true;
+}
+
+void NetArchive::store(const QString &key, Entry entry,
+                       const QString &dataFile) {
+    QDir().mkpath(folder + "/" + key.left(2));
+    QSaveFile outFile(dataPath(key));
+    if (!outFile.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    if (dataFile.isEmpty()) {
+        if (outFile.write(entry.data) != entry.data.size()) {
+            outFile.cancelWriting();
+        }
+    } else {
+        QFile inFile(dataFile);
+        if (!inFile.open(QIODevice::ReadOnly)) {
+            outFile.cancelWriting();
+        }
+        while (inFile.isOpen() && !inFile.atEnd()) {
+            const QByteArray chunk = inFile.read(1024 * 1024);
+            if (chunk.isEmpty() || outFile.write(chunk) != chunk.size()) {
+                outFile.cancelWriting();
+                break;
+            }
+        }
+    }
+    if (!outFile.commit()) {
+        return;
+    }
+
+    for (auto &header : entry.headers) {
+        if (SECRET_HEADERS.contains(header.first.toLower())) {
+            header.second = "****";
+        }
+    }
+    QSaveFile metaFile(filePath(key, ".meta"));
+    if (!metaFile.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&metaFile);
+    out << FORMAT_VERSION << entry.url << entry.postData << entry.headers
+        << entry.error << entry.httpStatus << entry.contentType
+        << entry.redirUrl << entry.elapsed;
+    if (out.status() == QDataStream::Ok) {
+        metaFile.commit();
+    }
+}
+
+int NetArchive::delay(const Entry &entry) {
+    return static_cast<int>(entry.elapsed * latency / 100);
+}
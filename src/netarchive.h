@@ -0,0 +1,80 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef NETARCHIVE_H
+#define NETARCHIVE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+/*
+ * Records the requests of the scraping modules together with their responses
+ * and how long they took, and plays them back later without any network.
+ * Meant for benchmarking and for reproducing a run exactly, such as on a
+ * machine without internet access.
+ *
+ * Responses are played back after the time they originally took, scaled by
+ * 'latency' percent. Requests are matched like HttpCache does it, so the
+ * credentials used don't matter. Credential headers and query items are left
+ * out of the recording, and NetComm masks the secrets it was given in the
+ * bodies. Other account data sent back by a server, such as the user name,
+ * is recorded as is.
+ *
+ * Every response is stored as a '.meta' file with the request and the headers
+ * and a '.data' file with the body, both replaced atomically, so the archive
+ * may be used by several threads at once.
+ */
+class NetArchive {
+public:
+    enum Mode { RECORD, REPLAY };
+
+    struct Entry {
+        QString url;
+        QByteArray postData;
+        QList<QPair<QByteArray, QByteArray>> headers; // Sent with the request
+        int error = 0; // QNetworkReply::NetworkError
+        int httpStatus = 0;
+        QByteArray contentType;
+        QByteArray redirUrl;
+        qint64 elapsed = 0; // Ms from sending the request until it was done
+        QByteArray data;
+    };
+
+    NetArchive(const QString &folder, const Mode mode, const int latency = 100);
+
+    bool isReplaying() { return mode == REPLAY; };
+    // Without 'withData' the body is left in the file at dataPath()
+    bool load(const QString &key, Entry &entry, const bool withData = true);
+    // The body is taken from 'dataFile' instead of 'entry' if given
+    void store(const QString &key, Entry entry,
+               const QString &dataFile = QString());
+    QString dataPath(const QString &key) { return filePath(key, ".data"); };
+    // Ms to wait before playing back 'entry'
+    int delay(const Entry &entry);
+
+private:
+    const QString folder;
+    const Mode mode;
+    const int latency;
+
+    QString filePath(const QString &key, const QString &suffix);
+};
+
+#endif // NETARCHIVE_H
@@ -25,19 +25,24 @@
 
 #include "netcomm.h"
 
+#include <QCryptographicHash>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
 #include <QNetworkRequest>
+#include <QTemporaryFile>
+#include <QThread>
 #include <QUrl>
+#include <functional>
 
 constexpr int MAXSIZE = 100 * 1000 * 1000;
 
-NetComm::NetComm(QSharedPointer<NetManager> manager) : manager(manager) {
-    requestTimer.setSingleShot(true);
-    requestTimer.setInterval(30000);
-    connect(&requestTimer, &QTimer::timeout, this, &NetComm::requestTimeout);
-}
+NetComm::NetComm(QSharedPointer<NetManager> manager) : manager(manager) {}
 
-void NetComm::request(QString query, QString postData,
-                      QList<QPair<QString, QString>> headers) {
+QNetworkRequest
+NetComm::makeRequest(const QString &query,
+                     const QList<QPair<QString, QString>> &headers) {
     QUrl url(query);
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::UserAgentHeader,
@@ -51,28 +56,691 @@ void NetComm::request(QString query, QString postData,
             request.setRawHeader(header.first.toUtf8(), header.second.toUtf8());
         }
     }
+    return request;
+}
+
+void NetComm::request(QString query, QString postData,
+                      QList<QPair<QString, QString>> headers) {
+    if (postData.isNull() && headers.isEmpty()) {
+        auto it = prefetched.find(query);
+        if (it != prefetched.end()) {
+            setResponse(it.value());
+            prefetched.erase(it);
+            // The caller waits for dataReady() in its event loop, so it can't
+            // be emitted before returning
+            QTimer::singleShot(0, this, &NetComm::dataReady);
+            return;
+        }
+    }
+
+    QNetworkRequest request = makeRequest(query, headers);
+    if (archive) {
+        archiveKey = HttpCache::key(query, postData);
+    }
+    if (archive && archive->isReplaying()) {
+        NetArchive::Entry entry;
+        replay(archiveKey, query, entry);
+        setResponse(fromArchive(entry));
+        QTimer::singleShot(archive->delay(entry), this, &NetComm::dataReady);
+        return;
+    }
+    cacheKey.clear();
+    hasCached = false;
+    if (isCacheable(query)) {
+        cacheKey = HttpCache::key(query, postData);
+        if (checkHttpCache(cacheKey, request, cached, hasCached)) {
+            setResponse(fromEntry(cached));
+            QTimer::singleShot(0, this, &NetComm::dataReady);
+            return;
+        }
+    }
 
+    // Another thread might be asking for the same right now, or have done so
+    // a moment ago
+    flightKey.clear();
     if (postData.isNull()) {
-        reply = manager->getRequest(request);
+        QString key = query;
+        for (const auto &header : headers) {
+            key.append("\n" + header.first + ": " + header.second);
+        }
+        Response shared;
+        if (coalescer->join(key, shared) == Coalescer::SERVED) {
+            setResponse(shared);
+            QTimer::singleShot(0, this, &NetComm::dataReady);
+            return;
+        }
+        flightKey = key;
+    }
+
+    pendingRequest = request;
+    pendingPost = postData.toUtf8();
+    pendingIsPost = !postData.isNull();
+    attempt = 0;
+    retryPolicy = RetryPolicy::get(request.url().host());
+    send();
+}
+
+void NetComm::send() {
+    retryPolicy->pass();
+    if (limiter) {
+        limiter->acquire();
+    }
+    sent.start();
+    if (pendingIsPost) {
+        reply = manager->postRequest(pendingRequest, pendingPost);
     } else {
-        reply = manager->postRequest(request, postData.toUtf8());
+        reply = manager->getRequest(pendingRequest);
     }
     connect(reply, &QNetworkReply::finished, this, &NetComm::replyReady);
     connect(reply, &QNetworkReply::downloadProgress, this,
             &NetComm::dataDownloaded);
-    requestTimer.start();
+    armTimeouts(reply);
+}
+
+// Aborts 'r' if it gets no connection, no response or isn't done within the
+// configured timeouts. The timers belong to the reply and go away with it
+void NetComm::armTimeouts(QNetworkReply *r, const bool total) {
+    auto arm = [r](const int seconds) {
+        QTimer *timer = new QTimer(r);
+        timer->setSingleShot(true);
+        connect(timer, &QTimer::timeout, r, [r]() {
+            printf("\033[1;33mRequest timed out, server might be busy / "
+                   "overloaded...\033[0m\n");
+            r->setProperty("timedOut", true);
+            r->abort();
+        });
+        timer->start(seconds * 1000);
+        return timer;
+    };
+#if QT_VERSION >= 0x060300
+    if (timeouts.connect > 0) {
+        connect(r, &QNetworkReply::requestSent, arm(timeouts.connect),
+                &QTimer::stop);
+    }
+#endif
+    if (timeouts.firstByte > 0) {
+        connect(r, &QNetworkReply::metaDataChanged,
+                arm(timeouts.firstByte), &QTimer::stop);
+    }
+    if (total && timeouts.total > 0) {
+        arm(timeouts.total);
+    }
+}
+
+NetComm::Response NetComm::readResponse(QNetworkReply *r) {
+    Response response = {
+        r->readAll(), r->error(), r->rawHeader("Content-Type"),
+        r->rawHeader("Location"),
+        r->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(),
+        {}};
+    // Aborted by armTimeouts()
+    if (r->property("timedOut").toBool()) {
+        response.error = QNetworkReply::TimeoutError;
+    }
+    return response;
 }
 
 void NetComm::replyReady() {
-    requestTimer.stop();
-    data = reply->readAll();
-    error = reply->error();
-    contentType = reply->rawHeader("Content-Type");
-    redirUrl = reply->rawHeader("Location");
+    Response response = readResponse(reply);
+    rateLimitFeedback(response.httpStatus);
+    const RetryPolicy::Verdict verdict =
+        classifier(response.error, response.httpStatus, response.data);
+    retryPolicy->record(verdict);
+    const int delay = retryPolicy->retryDelay(
+        verdict, attempt, reply->rawHeader("Retry-After").toInt());
+    if (delay >= 0) {
+        // dataReady() is only emitted once the request is done for good
+        reply->deleteLater();
+        ++attempt;
+        QTimer::singleShot(delay, this, &NetComm::send);
+        return;
+    }
+    // A response still failing once the retries run out isn't kept
+    if (!cacheKey.isEmpty() && verdict == RetryPolicy::DONE) {
+        updateHttpCache(cacheKey, reply, response, cached, hasCached);
+    }
+    cached = HttpCache::Entry();
+    if (archive) {
+        record(archiveKey, pendingRequest, pendingPost, response,
+               sent.elapsed());
+    }
+    if (!flightKey.isEmpty()) {
+        coalescer->finish(flightKey, response,
+                          verdict == RetryPolicy::DONE &&
+                              response.error == QNetworkReply::NoError &&
+                              response.httpStatus == 200);
+        flightKey.clear();
+    }
     reply->deleteLater();
+    setResponse(response);
     emit dataReady();
 }
 
+void NetComm::setResponse(const Response &response) {
+    data = response.data;
+    error = response.error;
+    contentType = response.contentType;
+    redirUrl = response.redirUrl;
+    httpStatus = response.httpStatus;
+}
+
+NetComm::Response NetComm::fromEntry(const HttpCache::Entry &entry) {
+    return {entry.data, QNetworkReply::NoError, entry.contentType,
+            entry.redirUrl, entry.httpStatus, {}};
+}
+
+NetComm::Response NetComm::fromArchive(const NetArchive::Entry &entry) {
+    return {entry.data, static_cast<QNetworkReply::NetworkError>(entry.error),
+            entry.contentType, entry.redirUrl, entry.httpStatus, {}};
+}
+
+void NetComm::record(const QString &key, const QNetworkRequest &request,
+                     const QByteArray &postData, const Response &response,
+                     const qint64 elapsed, const QString &dataFile) {
+    NetArchive::Entry entry;
+    entry.url = HttpCache::normalize(request.url().toString())
+                    .toString(QUrl::FullyEncoded);
+    entry.postData = postData;
+    for (const auto &header : request.rawHeaderList()) {
+        entry.headers.append(qMakePair(header, request.rawHeader(header)));
+    }
+    entry.error = response.error;
+    entry.httpStatus = response.httpStatus;
+    entry.contentType = response.contentType;
+    entry.redirUrl = response.redirUrl;
+    entry.elapsed = elapsed;
+    entry.data = response.data;
+    for (const auto &secret : secrets) {
+        entry.postData.replace(secret, "****");
+        entry.data.replace(secret, "****");
+    }
+    archive->store(key, entry, dataFile);
+}
+
+// Requests missing from the archive are answered as not found
+bool NetComm::replay(const QString &key, const QString &url,
+                     NetArchive::Entry &entry, const bool withData) {
+    if (archive->load(key, entry, withData)) {
+        return true;
+    }
+    printf("\033[1;33mNo recorded response for '%s', answering as not "
+           "found.\033[0m\n",
+           HttpCache::normalize(url).toString().toStdString().c_str());
+    entry = NetArchive::Entry();
+    entry.error = QNetworkReply::ContentNotFoundError;
+    entry.httpStatus = 404;
+    return false;
+}
+
+// True when the cached copy of 'key' is fresh enough to be used as is. A stale
+// copy is left in 'entry' and its validators are added to 'request', so the
+// server only sends the response again if it has changed
+bool NetComm::checkHttpCache(const QString &key, QNetworkRequest &request,
+                             HttpCache::Entry &entry, bool &found,
+                             const bool withData) {
+    found = httpCache->load(key, entry, withData);
+    if (!found) {
+        return false;
+    }
+    if (httpCache->isFresh(entry)) {
+        return true;
+    }
+    if (!entry.etag.isEmpty()) {
+        request.setRawHeader("If-None-Match", entry.etag);
+    }
+    if (!entry.lastModified.isEmpty()) {
+        request.setRawHeader("If-Modified-Since", entry.lastModified);
+    }
+    return false;
+}
+
+// Answers a '304 Not Modified' with the cached copy and keeps every other
+// successful response for next time
+void NetComm::updateHttpCache(const QString &key, QNetworkReply *r,
+                              Response &response, HttpCache::Entry &entry,
+                              const bool found) {
+    if (response.httpStatus == 304 && found) {
+        httpCache->touch(key, entry);
+        response = fromEntry(entry);
+        return;
+    }
+    if (response.error != QNetworkReply::NoError ||
+        response.httpStatus != 200 ||
+        r->rawHeader("Cache-Control").contains("no-store")) {
+        return;
+    }
+    HttpCache::Entry fresh;
+    fresh.data = response.data;
+    fresh.contentType = response.contentType;
+    fresh.redirUrl = response.redirUrl;
+    fresh.httpStatus = response.httpStatus;
+    fresh.etag = r->rawHeader("ETag");
+    fresh.lastModified = r->rawHeader("Last-Modified");
+    httpCache->store(key, fresh);
+}
+
+bool NetComm::isCacheable(const QString &url) {
+    return httpCache && !uncachedPaths.contains(QUrl(url).path());
+}
+
+void NetComm::rateLimitFeedback(const int status) {
+    if (!limiter) {
+        return;
+    }
+    if (status == 429) {
+        limiter->backOff();
+    } else if (status >= 200 && status < 400) {
+        limiter->succeeded();
+    }
+}
+
+// Downloads 'urls' with up to 'maxParallel' requests running at the same time
+// and keeps the responses. A following request() of one of the urls is then
+// answered from these instead of going to the network. Failed ones aren't
+// kept and not retried here, that is left to request()
+void NetComm::prefetch(const QStringList &urls, const int maxParallel) {
+    prefetched.clear();
+    QStringList pending;
+    for (const auto &url : urls) {
+        if (!url.isEmpty() && !pending.contains(url)) {
+            pending.append(url);
+        }
+    }
+    if (pending.isEmpty()) {
+        return;
+    }
+
+    // More connections to the host than the manager keeps open would only
+    // wait in its queue
+    const int parallel =
+        qBound(1, maxParallel, manager->getConnectionsPerHost());
+    if (archive && archive->isReplaying()) {
+        // Takes as long as it would with 'parallel' requests running at once
+        qint64 total = 0;
+        int longest = 0;
+        for (const auto &url : pending) {
+            NetArchive::Entry entry;
+            if (archive->load(HttpCache::key(url, QString()), entry)) {
+                prefetched.insert(url, fromArchive(entry));
+                total += archive->delay(entry);
+                longest = qMax(longest, archive->delay(entry));
+            }
+        }
+        QThread::msleep(qMax<qint64>(longest, total / parallel));
+        return;
+    }
+
+    QEventLoop loop;
+    QList<QNetworkReply *> running;
+    QElapsedTimer clock;
+    clock.start();
+
+    std::function<void()> startNext = [&]() {
+        while (!pending.isEmpty() && running.size() < parallel) {
+            const QString url = pending.takeFirst();
+            QNetworkRequest request =
+                makeRequest(url, QList<QPair<QString, QString>>());
+            QString key;
+            HttpCache::Entry entry;
+            bool found = false;
+            if (isCacheable(url)) {
+                key = HttpCache::key(url, QString());
+                if (checkHttpCache(key, request, entry, found)) {
+                    prefetched.insert(url, fromEntry(entry));
+                    continue;
+                }
+            }
+            // Same as request(), but without waiting for another thread, as
+            // it might be waiting for one of ours. request() waits later
+            Response shared;
+            const Coalescer::Role role = coalescer->join(url, shared, false);
+            if (role == Coalescer::SERVED) {
+                prefetched.insert(url, shared);
+                continue;
+            } else if (role == Coalescer::BUSY) {
+                continue;
+            }
+            // Waiting for the circuit here could wait for a probe sent by
+            // this very loop, so requests to a failing host are skipped
+            QSharedPointer<RetryPolicy> policy =
+                RetryPolicy::get(request.url().host());
+            if (!policy->tryPass()) {
+                coalescer->abandon(url);
+                continue;
+            }
+            if (limiter) {
+                limiter->acquire();
+            }
+            const qint64 started = clock.elapsed();
+            QNetworkReply *r = manager->getRequest(request);
+            running.append(r);
+            armTimeouts(r);
+            connect(r, &QNetworkReply::downloadProgress, &loop,
+                    [r](qint64 bytesReceived, qint64) {
+                        if (bytesReceived > MAXSIZE) {
+                            r->abort();
+                        }
+                    });
+            connect(
+                r, &QNetworkReply::finished, &loop,
+                [&, r, url, request, key, entry, found, policy,
+                 started]() mutable {
+                    Response response = readResponse(r);
+                    rateLimitFeedback(response.httpStatus);
+                    const RetryPolicy::Verdict verdict = classifier(
+                        response.error, response.httpStatus, response.data);
+                    policy->record(verdict);
+                    if (verdict == RetryPolicy::DONE) {
+                        if (!key.isEmpty()) {
+                            updateHttpCache(key, r, response, entry, found);
+                        }
+                        if (archive) {
+                            record(HttpCache::key(url, QString()), request,
+                                   QByteArray(), response,
+                                   clock.elapsed() - started);
+                        }
+                        prefetched.insert(url, response);
+                        coalescer->finish(
+                            url, response,
+                            response.error == QNetworkReply::NoError &&
+                                response.httpStatus == 200);
+                    } else {
+                        // Left to request(), which retries it
+                        coalescer->abandon(url);
+                    }
+                    running.removeOne(r);
+                    r->deleteLater();
+                    startNext();
+                    if (running.isEmpty()) {
+                        loop.quit();
+                    }
+                });
+        }
+    };
+    startNext();
+    // Everything might have been found in the http cache
+    if (!running.isEmpty()) {
+        loop.exec();
+    }
+}
+
+// Appends 'source' to 'target' chunk by chunk, adding the chunks to 'hash'
+static bool copyInto(const QString &source, QFileDevice &target,
+                     QCryptographicHash &hash) {
+    QFile inFile(source);
+    if (!inFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    while (!inFile.atEnd()) {
+        const QByteArray chunk = inFile.read(1024 * 1024);
+        if (chunk.isEmpty() || target.write(chunk) != chunk.size()) {
+            return false;
+        }
+        hash.addData(chunk);
+    }
+    return target.flush();
+}
+
+// Copies 'source' to a new file in 'folder', leaving it the way download()
+// does. The content type is left to the caller
+static bool copyDownload(const QString &source, const QString &folder,
+                         NetComm::Download &result) {
+    QDir().mkpath(folder);
+    QTemporaryFile file(folder + "/download-XXXXXX");
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!file.open() || !copyInto(source, file, hash) || file.size() == 0) {
+        return false;
+    }
+    file.setAutoRemove(false);
+    result.fileName = file.fileName();
+    result.size = file.size();
+    result.checksum = hash.result().toHex();
+    return true;
+}
+
+// Writes the response of 'query' to a new file in 'folder' as it arrives
+// instead of keeping it in memory, for videos and manuals. The download is
+// cancelled as soon as the response turns out not to be of 'contentType'
+// (anything goes when empty) or gets bigger than 'maxSize'. On success the
+// file is left for the caller to move into place, otherwise it is removed
+bool NetComm::download(const QString &query, const QString &folder,
+                       const QByteArray &contentType, const qint64 maxSize,
+                       Download &result) {
+    result = Download();
+    const qint64 limit = (maxSize > 0 && maxSize < MAXSIZE) ? maxSize : MAXSIZE;
+    const QString key =
+        archive ? HttpCache::key(query, QString()) : QString();
+    if (archive && archive->isReplaying()) {
+        return replayDownload(key, query, folder, contentType, limit, result);
+    }
+
+    QNetworkRequest request =
+        makeRequest(query, QList<QPair<QString, QString>>());
+    QString downloadKey;
+    HttpCache::Entry entry;
+    bool found = false;
+    if (isCacheable(query)) {
+        downloadKey = HttpCache::key(query, QString());
+        if (checkHttpCache(downloadKey, request, entry, found, false)) {
+            return fromHttpCache(downloadKey, entry, folder, contentType,
+                                 limit, result);
+        }
+    }
+
+    // Another thread might be downloading the same right now. It hands over a
+    // copy of its file, unless it didn't know about us in time or failed, in
+    // which case we download it ourselves
+    const QString flight = "download\n" + query + "\n" +
+                           QString::fromUtf8(contentType) + "\n" +
+                           QString::number(limit);
+    Response shared;
+    const bool leading = coalescer->join(flight, shared) == Coalescer::LEADER;
+    if (!leading && shared.file) {
+        setResponse(shared);
+        result.contentType = shared.contentType;
+        return copyDownload(shared.file->fileName(), folder, result);
+    }
+
+    QSharedPointer<RetryPolicy> policy =
+        RetryPolicy::get(request.url().host());
+    bool ok = false;
+    for (int attempt = 0;; ++attempt) {
+        policy->pass();
+        bool rejected = false;
+        int retryAfter = 0;
+        QElapsedTimer timer;
+        timer.start();
+        ok = downloadOnce(request, downloadKey, folder, contentType, limit,
+                          result, rejected, retryAfter);
+        // Not what we asked for, getting it again won't change that
+        const RetryPolicy::Verdict verdict =
+            (ok || rejected) ? RetryPolicy::DONE
+                             : classifier(error, httpStatus, QByteArray());
+        policy->record(verdict);
+        const int delay =
+            ok ? -1 : policy->retryDelay(verdict, attempt, retryAfter);
+        if (delay < 0) {
+            if (archive) {
+                // 'contentType' is what was asked for, not what was received
+                const Response response = {QByteArray(), error,
+                                           this->contentType, redirUrl,
+                                           httpStatus, {}};
+                record(key, request, QByteArray(), response, timer.elapsed(),
+                       result.fileName);
+            }
+            break;
+        }
+        QThread::msleep(delay);
+    }
+    if (!ok && httpStatus == 304 && found) {
+        httpCache->touch(downloadKey, entry);
+        ok = fromHttpCache(downloadKey, entry, folder, contentType, limit,
+                           result);
+    }
+
+    if (leading) {
+        if (ok) {
+            shareDownload(flight, folder, result);
+        } else {
+            coalescer->abandon(flight);
+        }
+    }
+    return ok;
+}
+
+// Hands out the cached copy of a download the same way download() does
+bool NetComm::fromHttpCache(const QString &key, const HttpCache::Entry &entry,
+                            const QString &folder,
+                            const QByteArray &contentType, const qint64 limit,
+                            Download &result) {
+    setResponse(fromEntry(entry));
+    const QString dataFile = httpCache->dataPath(key);
+    if ((!contentType.isEmpty() && !entry.contentType.contains(contentType)) ||
+        QFileInfo(dataFile).size() > limit) {
+        return false;
+    }
+    result.contentType = entry.contentType;
+    return copyDownload(dataFile, folder, result);
+}
+
+// Passes a copy of a finished download to the threads waiting for it. Their
+// own copies are made from it, after which it is removed
+void NetComm::shareDownload(const QString &flight, const QString &folder,
+                            const Download &result) {
+    Response response = {QByteArray(), error, contentType, redirUrl,
+                         httpStatus, {}};
+    if (coalescer->isAwaited(flight)) {
+        QSharedPointer<QTemporaryFile> file(
+            new QTemporaryFile(folder + "/download-XXXXXX"));
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        if (file->open() && copyInto(result.fileName, *file, hash)) {
+            file->close();
+            response.file = file;
+        }
+    }
+    coalescer->finish(flight, response, false);
+}
+
+// Same as download(), but from the archive. A response that was cancelled
+// when it was recorded has no data and fails here as well
+bool NetComm::replayDownload(const QString &key, const QString &query,
+                             const QString &folder,
+                             const QByteArray &contentType, const qint64 limit,
+                             Download &result) {
+    NetArchive::Entry entry;
+    replay(key, query, entry, false);
+    QThread::msleep(archive->delay(entry));
+    setResponse(fromArchive(entry));
+    const QString dataFile = archive->dataPath(key);
+    if (entry.error != QNetworkReply::NoError ||
+        (!contentType.isEmpty() && !entry.contentType.contains(contentType)) ||
+        QFileInfo(dataFile).size() > limit) {
+        return false;
+    }
+    result.contentType = entry.contentType;
+    return copyDownload(dataFile, folder, result);
+}
+
+bool NetComm::downloadOnce(const QNetworkRequest &request,
+                           const QString &downloadKey, const QString &folder,
+                           const QByteArray &contentType, const qint64 limit,
+                           Download &result, bool &rejected,
+                           int &retryAfter) {
+    result = Download();
+    QDir().mkpath(folder);
+    QTemporaryFile file(folder + "/download-XXXXXX");
+    if (!file.open()) {
+        rejected = true;
+        return false;
+    }
+
+    if (limiter) {
+        limiter->acquire();
+    }
+    QNetworkReply *r = manager->getRequest(request);
+    // No total timeout, big files take what they take as long as data arrives
+    armTimeouts(r, false);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QEventLoop loop;
+    QTimer idleTimer;
+    idleTimer.setSingleShot(true);
+    idleTimer.setInterval(30000);
+    connect(&idleTimer, &QTimer::timeout, &loop, [r]() {
+        printf("\033[1;33mRequest timed out, server might be busy / "
+               "overloaded...\033[0m\n");
+        r->setProperty("timedOut", true);
+        r->abort();
+    });
+    auto cancel = [&]() {
+        rejected = true;
+        r->abort();
+    };
+    connect(r, &QNetworkReply::metaDataChanged, &loop, [&]() {
+        const int status =
+            r->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status < 200 || status >= 300) {
+            return;
+        }
+        result.contentType = r->rawHeader("Content-Type");
+        if (!contentType.isEmpty() &&
+            !result.contentType.contains(contentType)) {
+            cancel();
+        } else if (r->header(QNetworkRequest::ContentLengthHeader)
+                       .toLongLong() > limit) {
+            cancel();
+        }
+    });
+    auto writeChunk = [&]() {
+        const QByteArray chunk = r->readAll();
+        if (rejected || chunk.isEmpty()) {
+            return;
+        }
+        result.size += chunk.size();
+        if (result.size > limit || file.write(chunk) != chunk.size()) {
+            cancel();
+            return;
+        }
+        hash.addData(chunk);
+        idleTimer.start();
+    };
+    connect(r, &QNetworkReply::readyRead, &loop, writeChunk);
+    connect(r, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    idleTimer.start();
+    loop.exec();
+    idleTimer.stop();
+    writeChunk();
+
+    data = QByteArray();
+    error = r->property("timedOut").toBool() ? QNetworkReply::TimeoutError
+                                              : r->error();
+    this->contentType = result.contentType;
+    redirUrl = r->rawHeader("Location");
+    httpStatus = r->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    retryAfter = r->rawHeader("Retry-After").toInt();
+    r->deleteLater();
+    rateLimitFeedback(httpStatus);
+    if (rejected || error != QNetworkReply::NoError || result.size == 0 ||
+        !file.flush()) {
+        result = Download();
+        return false;
+    }
+    // Same as updateHttpCache() does for responses kept in memory
+    if (!downloadKey.isEmpty() && httpStatus == 200 &&
+        !r->rawHeader("Cache-Control").contains("no-store")) {
+        HttpCache::Entry fresh;
+        fresh.contentType = result.contentType;
+        fresh.redirUrl = redirUrl;
+        fresh.httpStatus = httpStatus;
+        fresh.etag = r->rawHeader("ETag");
+        fresh.lastModified = r->rawHeader("Last-Modified");
+        httpCache->store(downloadKey, fresh, file.fileName());
+    }
+    file.setAutoRemove(false);
+    result.fileName = file.fileName();
+    result.checksum = hash.result().toHex();
+    return true;
+}
+
 QByteArray NetComm::getData() { return data; }
 
 QNetworkReply::NetworkError NetComm::getError(const int &verbosity) {
@@ -136,6 +804,8 @@ QByteArray NetComm::getContentType() { return contentType; }
 
 QByteArray NetComm::getRedirUrl() { return redirUrl; }
 
+int NetComm::getHttpStatus() { return httpStatus; }
+
 void NetComm::dataDownloaded(qint64 bytesReceived, qint64) {
     if (bytesReceived > MAXSIZE) {
         printf("Retrieved data size exceeded maximum of 100 MB, cancelling "
@@ -143,9 +813,3 @@ void NetComm::dataDownloaded(qint64 bytesReceived, qint64) {
         reply->abort();
     }
 }
-
-void NetComm::requestTimeout() {
-    printf("\033[1;33mRequest timed out, server might be busy / "
-           "overloaded...\033[0m\n");
-    reply->abort();
-}
@@ -26,8 +26,15 @@
 #ifndef NETCOMM_H
 #define NETCOMM_H
 
+#include "coalescer.h"
+#include "httpcache.h"
+#include "netarchive.h"
 #include "netmanager.h"
+#include "ratelimiter.h"
+#include "retrypolicy.h"
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QNetworkReply>
 #include <QTimer>
 
@@ -35,31 +42,137 @@ class NetComm : public QObject {
     Q_OBJECT
 
 public:
+    // A response streamed to disk by download()
+    struct Download {
+        QString fileName;
+        QByteArray contentType;
+        qint64 size = 0;
+        QString checksum; // Sha1, worked out while downloading
+    };
+    // In seconds, 0 is no limit. 'connect' needs Qt 6.3 or later, before that
+    // only the other two apply
+    struct Timeouts {
+        int connect = 10;
+        int firstByte = 30;
+        int total = 120;
+    };
+
     NetComm(QSharedPointer<NetManager> manager);
     void request(QString query, QString postData = QString(),
                  QList<QPair<QString, QString>> headers =
                      QList<QPair<QString, QString>>());
+    void prefetch(const QStringList &urls, const int maxParallel);
+    bool download(const QString &query, const QString &folder,
+                  const QByteArray &contentType, const qint64 maxSize,
+                  Download &result);
+    void clearPrefetched() { prefetched.clear(); };
+    // Every request sent to the network waits for 'limiter' from then on
+    void setRateLimiter(QSharedPointer<RateLimiter> limiter) {
+        this->limiter = limiter;
+    };
+    // Responses are kept in and revalidated against 'httpCache' from then on
+    void setHttpCache(QSharedPointer<HttpCache> httpCache) {
+        this->httpCache = httpCache;
+    };
+    // Responses from these url paths carry account data and are never kept
+    // in the http cache
+    void setUncachedPaths(const QStringList &paths) { uncachedPaths = paths; };
+    // Requests are recorded to or played back from 'archive' from then on
+    void setArchive(QSharedPointer<NetArchive> archive) {
+        this->archive = archive;
+    };
+    // Masked in everything recorded to the archive, as some servers echo the
+    // credentials they were sent
+    void addSecret(const QByteArray &secret) {
+        if (!secret.isEmpty()) {
+            secrets.append(secret);
+        }
+    };
+    void setTimeouts(const Timeouts &timeouts) { this->timeouts = timeouts; };
+    // Tells which responses are failures to be retried, see RetryPolicy
+    void setClassifier(RetryPolicy::Classifier classifier) {
+        this->classifier = classifier;
+    };
     QByteArray getData();
     QNetworkReply::NetworkError getError(const int &verbosity = 0);
     QByteArray getContentType();
     QByteArray getRedirUrl();
+    int getHttpStatus();
 
 private slots:
     void replyReady();
     void dataDownloaded(qint64 bytesReceived, qint64);
-    void requestTimeout();
 
 signals:
     void dataReady();
 
 private:
+    typedef Coalescer::Response Response;
+
     QSharedPointer<NetManager> manager;
-    QTimer requestTimer;
+    Timeouts timeouts;
+    RetryPolicy::Classifier classifier = RetryPolicy::classify;
     QByteArray data;
     QNetworkReply::NetworkError error;
     QByteArray contentType;
     QByteArray redirUrl;
+    int httpStatus = 0;
     QNetworkReply *reply;
+    QSharedPointer<RateLimiter> limiter;
+    QHash<QString, Response> prefetched;
+    QSharedPointer<HttpCache> httpCache;
+    QStringList uncachedPaths;
+    QSharedPointer<NetArchive> archive;
+    QList<QByteArray> secrets;
+    // Cached copy of the running request, if any
+    QString cacheKey;
+    HttpCache::Entry cached;
+    bool hasCached = false;
+    // The running request, kept to send it again
+    QNetworkRequest pendingRequest;
+    QByteArray pendingPost;
+    bool pendingIsPost = false;
+    int attempt = 0;
+    QSharedPointer<RetryPolicy> retryPolicy;
+    QString archiveKey;
+    QElapsedTimer sent;
+    QSharedPointer<Coalescer> coalescer = Coalescer::get();
+    // Set while leading a request shared with other threads
+    QString flightKey;
+
+    QNetworkRequest makeRequest(const QString &query,
+                                const QList<QPair<QString, QString>> &headers);
+    void rateLimitFeedback(const int status);
+    void send();
+    void armTimeouts(QNetworkReply *r, const bool total = true);
+    Response readResponse(QNetworkReply *r);
+    bool replayDownload(const QString &key, const QString &query,
+                        const QString &folder, const QByteArray &contentType,
+                        const qint64 limit, Download &result);
+    bool fromHttpCache(const QString &key, const HttpCache::Entry &entry,
+                       const QString &folder, const QByteArray &contentType,
+                       const qint64 limit, Download &result);
+    void shareDownload(const QString &flight, const QString &folder,
+                       const Download &result);
+    bool downloadOnce(const QNetworkRequest &request,
+                      const QString &downloadKey, const QString &folder,
+                      const QByteArray &contentType, const qint64 limit,
+                      Download &result, bool &rejected, int &retryAfter);
+    void setResponse(const Response &response);
+    bool isCacheable(const QString &url);
+    bool checkHttpCache(const QString &key, QNetworkRequest &request,
+                        HttpCache::Entry &entry, bool &found,
+                        const bool withData = true);
+    void updateHttpCache(const QString &key, QNetworkReply *r,
+                         Response &response, HttpCache::Entry &entry,
+                         const bool found);
+    static Response fromEntry(const HttpCache::Entry &entry);
+    void record(const QString &key, const QNetworkRequest &request,
+                const QByteArray &postData, const Response &response,
+                const qint64 elapsed, const QString &dataFile = QString());
+    bool replay(const QString &key, const QString &url,
+                NetArchive::Entry &entry, const bool withData = true);
+    static Response fromArchive(const NetArchive::Entry &entry);
 };
 
 #endif // NETCOMM_H
@@ -25,17 +25,74 @@
 
 #include "netmanager.h"
 
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QNetworkRequest>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+#include <QHttp1Configuration>
+#endif
+#ifndef QT_NO_SSL
+#include <QSslConfiguration>
+#endif
 
-NetManager::NetManager() {}
+#ifndef QT_NO_SSL
+// Last TLS session ticket received from each host, by any of the managers
+static QMutex sessionMutex;
+static QHash<QString, QByteArray> sessionTickets;
+#endif
+
+NetManager::NetManager(const int connectionsPerHost)
+    : connectionsPerHost(qMax(1, connectionsPerHost)) {}
 
 QNetworkReply *NetManager::getRequest(const QNetworkRequest &request) {
-    QMutexLocker locker(&requestMutex);
-    return get(request);
+    QNetworkReply *reply = get(prepare(request));
+    keepSession(reply);
+    return reply;
 }
 
 QNetworkReply *NetManager::postRequest(const QNetworkRequest &request,
                                        const QByteArray &data) {
-    QMutexLocker locker(&requestMutex);
-    return post(request, data);
+    QNetworkReply *reply = post(prepare(request), data);
+    keepSession(reply);
+    return reply;
+}
+
+QNetworkRequest NetManager::prepare(const QNetworkRequest &request) {
+    QNetworkRequest prepared(request);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    QHttp1Configuration http1;
+    http1.setNumberOfConnectionsPerHost(connectionsPerHost);
+    prepared.setHttp1Configuration(http1);
+#endif
+#ifndef QT_NO_SSL
+    if (prepared.url().scheme() == "https") {
+        QSslConfiguration ssl = prepared.sslConfiguration();
+        ssl.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+        QMutexLocker locker(&sessionMutex);
+        const QByteArray ticket = sessionTickets.value(prepared.url().host());
+        if (!ticket.isEmpty()) {
+            ssl.setSessionTicket(ticket);
+        }
+        prepared.setSslConfiguration(ssl);
+    }
+#endif
+    return prepared;
+}
+
+void NetManager::keepSession(QNetworkReply *reply) {
+#ifndef QT_NO_SSL
+    if (reply->url().scheme() != "https") {
+        return;
+    }
+    connect(reply, &QNetworkReply::finished, this, [reply]() {
+        const QByteArray ticket = reply->sslConfiguration().sessionTicket();
+        if (!ticket.isEmpty()) {
+            QMutexLocker locker(&sessionMutex);
+            sessionTickets.insert(reply->url().host(), ticket);
+        }
+    });
+#else
+    Q_UNUSED(reply);
+#endif
 }
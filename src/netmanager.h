@@ -26,20 +26,30 @@
 #ifndef NETMANAGER_H
 #define NETMANAGER_H
 
-#include <QMutex>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 
+/*
+ * Every thread doing requests owns a NetManager of its own, so requests are
+ * never handed to another thread and each thread keeps its connections to the
+ * hosts open between requests. The TLS sessions are shared between all of
+ * them, so a new connection to a host resumes a session instead of doing a
+ * full handshake.
+ */
 class NetManager : public QNetworkAccessManager {
     Q_OBJECT
 
 public:
-    NetManager();
+    NetManager(const int connectionsPerHost = 6);
     QNetworkReply *getRequest(const QNetworkRequest &request);
     QNetworkReply *postRequest(const QNetworkRequest &request,
                                const QByteArray &data);
+    int getConnectionsPerHost() { return connectionsPerHost; };
 
 private:
-    QMutex requestMutex;
+    const int connectionsPerHost;
+
+    QNetworkRequest prepare(const QNetworkRequest &request);
+    void keepSession(QNetworkReply *reply);
 };
 #endif // NETMANAGER_H
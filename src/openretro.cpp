@@ -90,6 +90,19 @@ OpenRetro::OpenRetro(Settings *config, QSharedPointer<NetManager> manager)
     fetchOrder.append(TAGS);
     fetchOrder.append(RELEASEDATE);
     fetchOrder.append(RATING);
+
+    // Don't change! OpenRetro asked for a single connection at a time
+    mediaParallel = 1;
+}
+
+QString OpenRetro::getMediaUrl(const int type, const GameEntry &) {
+    QString url;
+    if (type == COVER) {
+        url = peekUrl(coverPre, coverPost);
+    } else if (type == MARQUEE) {
+        url = peekUrl(marqueePre, marqueePost);
+    }
+    return url.isEmpty() ? url : url + "?s=512";
 }
 
 void OpenRetro::getSearchResults(QList<GameEntry> &gameEntries,
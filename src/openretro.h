@@ -45,6 +45,7 @@ private:
     void getRating(GameEntry &game) override;
     void getCover(GameEntry &game) override;
     void getMarquee(GameEntry &game) override;
+    QString getMediaUrl(const int type, const GameEntry &game) override;
 };
 
 #endif // OPENRETRO_H
@@ -320,7 +320,7 @@ QString Pegasus::toPegasusFormat(const QString &key, const QString &value) {
     return pegasusFormat;
 }
 
-void Pegasus::assembleList(QString &finalOutput,
+void Pegasus::assembleList(GameListWriter &finalOutput,
                            QList<GameEntry> &gameEntries) {
     /*
     QList<QString> extensionsList;
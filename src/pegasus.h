@@ -33,7 +33,7 @@ class Pegasus : public AbstractFrontend {
 
 public:
     Pegasus();
-    void assembleList(QString &finalOutput,
+    void assembleList(GameListWriter &finalOutput,
                       QList<GameEntry> &gameEntries) override;
     bool skipExisting(QList<GameEntry> &gameEntries,
                       QSharedPointer<Queue> queue) override;
@@ -26,35 +26,74 @@
 #include "queue.h"
 
 #include <QRegularExpression>
+#include <algorithm>
+#include <vector>
 
 Queue::Queue() {}
 
-bool Queue::hasEntry() {
-    queueMutex.lock();
-    if (isEmpty()) {
-        queueMutex.unlock();
+// Sets the order the entries are handed out in. "largest" starts with the
+// biggest files so the longest hashes don't end up last, "folder" groups the
+// files by folder for disk locality. Anything else keeps the listed order
+void Queue::sortEntries(const QString &order) {
+    if (order != "largest" && order != "folder") {
+        return;
+    }
+    // Work out the keys once instead of on every comparison
+    if (order == "largest") {
+        std::vector<std::pair<QFileInfo, qint64>> sizes;
+        for (const auto &info : *this) {
+            sizes.emplace_back(info, info.size());
+        }
+        std::stable_sort(sizes.begin(), sizes.end(),
+                         [](const auto &a, const auto &b) {
+                             return a.second > b.second;
+                         });
+        clear();
+        for (const auto &entry : sizes) {
+            append(entry.first);
+        }
+    } else {
+        std::vector<std::pair<QFileInfo, QString>> entries;
+        for (const auto &info : *this) {
+            entries.emplace_back(info, info.absolutePath());
+        }
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const auto &a, const auto &b) {
+                             return a.second < b.second;
+                         });
+        clear();
+        for (const auto &entry : entries) {
+            append(entry.first);
+        }
+    }
+}
+
+bool Queue::takeEntry(QFileInfo &info) {
+    if (cancelled) {
+        return false;
+    }
+    const int idx = nextEntry++;
+    if (idx >= size()) {
         return false;
     }
+    info = at(idx);
     return true;
 }
 
-QFileInfo Queue::takeEntry() {
-    QFileInfo info = first();
-    removeFirst();
-    queueMutex.unlock();
-    return info;
+int Queue::remaining() const {
+    if (cancelled) {
+        return 0;
+    }
+    return qMax(0, (int)size() - nextEntry.load());
 }
 
-void Queue::clearAll() {
-    queueMutex.lock();
-    clear();
-    queueMutex.unlock();
-}
+// Only sets a flag, which makes this safe to call from the SIGINT handler and
+// while other threads are taking entries
+void Queue::clearAll() { cancelled = true; }
 
 void Queue::filterFiles(const QString &patterns, const bool &include) {
     QList<QString> regExpPatterns = getRegExpPatterns(patterns);
 
-    queueMutex.lock();
     QMutableListIterator<QFileInfo> it(*this);
     while (it.hasNext()) {
         QFileInfo info = it.next();
@@ -72,11 +111,9 @@ void Queue::filterFiles(const QString &patterns, const bool &include) {
             it.remove();
         }
     }
-    queueMutex.unlock();
 }
 
 void Queue::removeFiles(const QList<QString> &files) {
-    queueMutex.lock();
     QMutableListIterator<QFileInfo> it(*this);
     while (it.hasNext()) {
         QFileInfo info = it.next();
@@ -87,7 +124,6 @@ void Queue::removeFiles(const QList<QString> &files) {
             }
         }
     }
-    queueMutex.unlock();
 }
 
 QList<QString> Queue::getRegExpPatterns(QString patterns) {
@@ -28,19 +28,25 @@
 
 #include <QFileInfo>
 #include <QList>
-#include <QMutex>
+#include <atomic>
 
+// The list is filled and filtered before any threads are started. After that
+// entries are only handed out through takeEntry(), which any number of threads
+// can call at the same time without locking
 class Queue : public QList<QFileInfo> {
 public:
     Queue();
-    bool hasEntry();
-    QFileInfo takeEntry();
+    void sortEntries(const QString &order);
+    bool takeEntry(QFileInfo &info);
+    int remaining() const;
+    bool isCancelled() const { return cancelled; };
     void clearAll();
     void filterFiles(const QString &patterns, const bool &include = false);
     void removeFiles(const QList<QString> &files);
 
 private:
-    QMutex queueMutex;
+    std::atomic<int> nextEntry{0};
+    std::atomic<bool> cancelled{false};
     QList<QString> getRegExpPatterns(QString patterns);
 };
 
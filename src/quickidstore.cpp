@@ -0,0 +1,249 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include "quickidstore.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+#include <QXmlStreamAttributes>
+#include <QXmlStreamReader>
+
+#if !defined(Q_OS_WIN)
+#include <sys/stat.h>
+#endif
+
+static const quint32 FORMAT_VERSION = 1;
+
+bool QuickIdStore::load(const QString &binPath, const QString &xmlPath) {
+    QWriteLocker locker(&lock);
+    quickIds.clear();
+    byInode.clear();
+    dirty = false;
+
+    QFile binFile(binPath);
+    if (!binFile.open(QIODevice::ReadOnly)) {
+        return loadXml(xmlPath);
+    }
+    QDataStream in(&binFile);
+    quint32 version = 0;
+    quint32 count = 0;
+    in >> version >> count;
+    if (in.status() != QDataStream::Ok || version != FORMAT_VERSION) {
+        return loadXml(xmlPath);
+    }
+    quickIds.reserve(count);
+    for (quint32 a = 0; a < count; ++a) {
+        QString filePath;
+        QuickId quickId;
+        in >> filePath >> quickId.device >> quickId.inode >> quickId.size >>
+            quickId.modified >> quickId.cacheId;
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+        insert(filePath, quickId);
+    }
+    if (in.status() != QDataStream::Ok) {
+        quickIds.clear();
+        byInode.clear();
+        return loadXml(xmlPath);
+    }
+    return true;
+}
+
+// Imports the quick ids of older versions. These lack the file size and inode,
+// which are filled in once a file gets hashed again
+bool QuickIdStore::loadXml(const QString &xmlPath) {
+    QFile quickIdFile(xmlPath);
+    if (!quickIdFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QXmlStreamReader xml(&quickIdFile);
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement) {
+            continue;
+        }
+        if (xml.name() != "quickid") {
+            continue;
+        }
+        QXmlStreamAttributes attribs = xml.attributes();
+        if (!attribs.hasAttribute("filepath") ||
+            !attribs.hasAttribute("timestamp") ||
+            !attribs.hasAttribute("id")) {
+            continue;
+        }
+        QuickId quickId;
+        quickId.modified = attribs.value("timestamp").toLongLong();
+        quickId.cacheId = attribs.value("id").toString();
+        insert(attribs.value("filepath").toString(), quickId);
+    }
+    importedXml = true;
+    dirty = !quickIds.isEmpty();
+    return !quickIds.isEmpty();
+}
+
+bool QuickIdStore::save(const QString &binPath, const QString &xmlPath) {
+    QWriteLocker locker(&lock);
+    if (!dirty) {
+        return true;
+    }
+    QSaveFile binFile(binPath);
+    if (!binFile.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream out(&binFile);
+    out << FORMAT_VERSION << (quint32)quickIds.size();
+    for (auto it = quickIds.cbegin(); it != quickIds.cend(); ++it) {
+        out << it.key() << it.value().device << it.value().inode
+            << it.value().size << it.value().modified << it.value().cacheId;
+    }
+    if (out.status() != QDataStream::Ok || !binFile.commit()) {
+        return false;
+    }
+    if (importedXml) {
+        QFile::remove(xmlPath);
+        importedXml = false;
+    }
+    dirty = false;
+    return true;
+}
+
+QString QuickIdStore::get(const QFileInfo &info) {
+    const QString filePath = info.absoluteFilePath();
+    {
+        QReadLocker locker(&lock);
+        auto it = quickIds.constFind(filePath);
+        if (it != quickIds.constEnd()) {
+            return isCurrent(it.value(), info) ? it.value().cacheId
+                                               : QString();
+        }
+        if (byInode.isEmpty()) {
+            return QString();
+        }
+    }
+
+    // Unknown path, but the file might just have been moved or renamed
+    FileKey key;
+    if (!fileKey(filePath, key)) {
+        return QString();
+    }
+    QWriteLocker locker(&lock);
+    auto inodeIt = byInode.constFind(key);
+    if (inodeIt == byInode.constEnd()) {
+        return QString();
+    }
+    const QString oldPath = inodeIt.value();
+    auto it = quickIds.find(oldPath);
+    // Inodes of deleted files are reused right away, so unlike isCurrent()
+    // both size and mtime must match exactly. A move or rename keeps them
+    if (it == quickIds.end() || it.value().device != key.first ||
+        it.value().inode != key.second || it.value().size != info.size() ||
+        it.value().modified != info.lastModified().toMSecsSinceEpoch()) {
+        return QString();
+    }
+    QuickId quickId = it.value();
+    // A hard link leaves the old path in place, keep both then
+    if (!QFileInfo::exists(oldPath)) {
+        quickIds.erase(it);
+    }
+    insert(filePath, quickId);
+    dirty = true;
+    return quickId.cacheId;
+}
+
+void QuickIdStore::add(const QFileInfo &info, const QString &cacheId) {
+    QuickId quickId;
+    quickId.size = info.size();
+    quickId.modified = info.lastModified().toMSecsSinceEpoch();
+    quickId.cacheId = cacheId;
+    FileKey key;
+    if (fileKey(info.absoluteFilePath(), key)) {
+        quickId.device = key.first;
+        quickId.inode = key.second;
+    }
+    QWriteLocker locker(&lock);
+    insert(info.absoluteFilePath(), quickId);
+    dirty = true;
+}
+
+void QuickIdStore::retain(const QList<QFileInfo> &fileInfos) {
+    QSet<QString> filePaths;
+    filePaths.reserve(fileInfos.size());
+    for (const auto &info : fileInfos) {
+        filePaths.insert(info.absoluteFilePath());
+    }
+    QWriteLocker locker(&lock);
+    QHash<QString, QuickId> kept;
+    for (auto it = quickIds.cbegin(); it != quickIds.cend(); ++it) {
+        if (filePaths.contains(it.key())) {
+            kept.insert(it.key(), it.value());
+        }
+    }
+    if (kept.size() == quickIds.size()) {
+        return;
+    }
+    quickIds.clear();
+    byInode.clear();
+    for (auto it = kept.cbegin(); it != kept.cend(); ++it) {
+        insert(it.key(), it.value());
+    }
+    dirty = true;
+}
+
+int QuickIdStore::size() {
+    QReadLocker locker(&lock);
+    return quickIds.size();
+}
+
+bool QuickIdStore::isDirty() {
+    QReadLocker locker(&lock);
+    return dirty;
+}
+
+// Must be called with 'lock' locked for writing
+void QuickIdStore::insert(const QString &filePath, const QuickId &quickId) {
+    quickIds.insert(filePath, quickId);
+    if (quickId.inode != 0) {
+        byInode.insert(qMakePair(quickId.device, quickId.inode), filePath);
+    }
+}
+
+bool QuickIdStore::isCurrent(const QuickId &quickId, const QFileInfo &info) {
+    if (quickId.size != -1 && quickId.size != info.size()) {
+        return false;
+    }
+    return info.lastModified().toMSecsSinceEpoch() <= quickId.modified;
+}
+
+bool QuickIdStore::fileKey(const QString &filePath, FileKey &key) {
+#if !defined(Q_OS_WIN)
+    struct stat fileStat;
+    if (stat(QFile::encodeName(filePath).constData(), &fileStat) != 0) {
+        return false;
+    }
+    key = qMakePair((quint64)fileStat.st_dev, (quint64)fileStat.st_ino);
+    return true;
+#else
+    // No inodes to go by, moved files are hashed again
+    Q_UNUSED(filePath);
+    Q_UNUSED(key);
+    return false;
+#endif
+}
@@ -0,0 +1,73 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef QUICKIDSTORE_H
+#define QUICKIDSTORE_H
+
+#include <QFileInfo>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QReadWriteLock>
+#include <QString>
+
+/*
+ * Remembers the cacheId of every rom file so it doesn't have to be hashed
+ * again on the next run. Besides the path, the device, inode, size and
+ * modification time of the file are kept. A file that was moved or renamed
+ * keeps its inode and is found again by it.
+ *
+ * Stored in 'quickid.bin'. An old 'quickid.xml' is imported once and removed
+ * after the first save. All methods are thread safe.
+ */
+class QuickIdStore {
+public:
+    bool load(const QString &binPath, const QString &xmlPath);
+    bool save(const QString &binPath, const QString &xmlPath);
+
+    QString get(const QFileInfo &info);
+    void add(const QFileInfo &info, const QString &cacheId);
+    // Drops every file not in 'fileInfos'
+    void retain(const QList<QFileInfo> &fileInfos);
+
+    int size();
+    bool isDirty();
+
+private:
+    struct QuickId {
+        quint64 device = 0;
+        quint64 inode = 0;
+        qint64 size = -1; // Unknown for ids imported from 'quickid.xml'
+        qint64 modified = 0;
+        QString cacheId;
+    };
+    typedef QPair<quint64, quint64> FileKey; // device, inode
+
+    QReadWriteLock lock;
+    QHash<QString, QuickId> quickIds; // absolute file path
+    QHash<FileKey, QString> byInode;
+    bool dirty = false;
+    bool importedXml = false;
+
+    static bool fileKey(const QString &filePath, FileKey &key);
+    static bool isCurrent(const QuickId &quickId, const QFileInfo &info);
+    bool loadXml(const QString &xmlPath);
+    void insert(const QString &filePath, const QuickId &quickId);
+};
+
+#endif // QUICKIDSTORE_H
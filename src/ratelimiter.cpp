@@ -0,0 +1,102 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include "ratelimiter.h"
+
+#include <QHash>
+#include <QMutexLocker>
+#include <QtMath>
+
+constexpr int MAXSLOWDOWN = 16;
+constexpr int RECOVERAFTER = 10;
+
+QSharedPointer<RateLimiter> RateLimiter::get(const QString &name,
+                                             const int interval,
+                                             const int burst) {
+    static QMutex registryMutex;
+    static QHash<QString, QSharedPointer<RateLimiter>> registry;
+    QMutexLocker locker(&registryMutex);
+    auto it = registry.constFind(name);
+    if (it != registry.constEnd()) {
+        return it.value();
+    }
+    QSharedPointer<RateLimiter> limiter(
+        new RateLimiter(name, interval, burst));
+    registry.insert(name, limiter);
+    return limiter;
+}
+
+RateLimiter::RateLimiter(const QString &name, const int interval,
+                         const int burst)
+    : name(name), interval(qMax(1, interval)), burst(qMax(1, burst)) {
+    // Start with a single token. A run that starts right after another one
+    // would otherwise send a full burst at once
+    tokens = 1.0;
+    clock.start();
+}
+
+// Must be called with 'mutex' locked
+void RateLimiter::refill() {
+    const qint64 now = clock.elapsed();
+    tokens = qMin((double)burst, tokens + (double)(now - lastRefill) /
+                                              (interval * slowdown));
+    lastRefill = now;
+}
+
+void RateLimiter::acquire() {
+    QMutexLocker locker(&mutex);
+    refill();
+    while (tokens < 1.0) {
+        tokenAdded.wait(&mutex,
+                        qCeil((1.0 - tokens) * interval * slowdown));
+        refill();
+    }
+    tokens -= 1.0;
+    // Another thread might be able to go as well
+    if (tokens >= 1.0) {
+        tokenAdded.wakeOne();
+    }
+}
+
+void RateLimiter::backOff() {
+    QMutexLocker locker(&mutex);
+    refill();
+    successes = 0;
+    tokens = 0.0;
+    if (slowdown < MAXSLOWDOWN) {
+        slowdown *= 2;
+        printf("\033[1;33m'%s' asks for fewer requests, waiting %d ms "
+               "between requests now...\033[0m\n",
+               name.toStdString().c_str(), interval * slowdown);
+    }
+}
+
+int RateLimiter::getInterval() {
+    QMutexLocker locker(&mutex);
+    return interval * slowdown;
+}
+
+void RateLimiter::succeeded() {
+    QMutexLocker locker(&mutex);
+    if (slowdown == 1 || ++successes < RECOVERAFTER) {
+        return;
+    }
+    refill();
+    successes = 0;
+    slowdown /= 2;
+}
@@ -0,0 +1,71 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QWaitCondition>
+
+/*
+ * Token bucket shared by every thread scraping with the same module. A token
+ * is added every 'interval' ms up to 'burst' tokens and each request takes
+ * one, so the module gets its full request rate no matter which threads are
+ * busy with something else.
+ *
+ * backOff() is called when the service says it gets too many requests. It
+ * doubles the interval, up to 16 times the configured one. Every 10 requests
+ * that go through after that halve it again until it is back where it
+ * started. All methods are thread safe.
+ */
+class RateLimiter {
+public:
+    // Returns the limiter of 'name', creating it on first use. Later calls
+    // get the same limiter and their 'interval' and 'burst' are ignored
+    static QSharedPointer<RateLimiter> get(const QString &name,
+                                           const int interval,
+                                           const int burst = 1);
+
+    RateLimiter(const QString &name, const int interval, const int burst);
+
+    // Blocks until a request may be sent
+    void acquire();
+    void backOff();
+    void succeeded();
+    // Ms between two requests at the moment
+    int getInterval();
+
+private:
+    const QString name;
+    const int interval;
+    const int burst;
+    int slowdown = 1;
+    int successes = 0;
+    double tokens;
+    QElapsedTimer clock;
+    qint64 lastRefill = 0;
+    QMutex mutex;
+    QWaitCondition tokenAdded;
+
+    void refill();
+};
+
+#endif // RATELIMITER_H
@@ -0,0 +1,53 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include "renderpool.h"
+
+#include <QtGlobal>
+
+RenderPool::RenderPool(const int threads) : jobs(qMax(1, threads) * 2) {
+    for (int a = 0; a < qMax(1, threads); ++a) {
+        workers.push_back(
+            std::async(std::launch::async, &RenderPool::work, this));
+    }
+}
+
+RenderPool::~RenderPool() {
+    jobs.close();
+    for (auto &worker : workers) {
+        worker.wait();
+    }
+}
+
+std::future<void> RenderPool::submit(std::function<void()> job) {
+    Job task = std::make_shared<std::packaged_task<void()>>(std::move(job));
+    std::future<void> done = task->get_future();
+    if (!jobs.push(task)) {
+        // Shutting down, render on the calling thread instead
+        (*task)();
+    }
+    return done;
+}
+
+void RenderPool::work() {
+    Job task;
+    while (jobs.pop(task)) {
+        (*task)();
+        task.reset();
+    }
+}
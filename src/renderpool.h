@@ -0,0 +1,51 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef RENDERPOOL_H
+#define RENDERPOOL_H
+
+#include "boundedqueue.h"
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+/*
+ * Threads that render artwork for the Compositor, one per core. Rendering is
+ * CPU bound, so it runs here instead of on the threads that feed it, which
+ * mostly wait on the cache and the drive. submit() blocks while enough jobs
+ * are queued to keep every thread busy.
+ */
+class RenderPool {
+public:
+    explicit RenderPool(const int threads);
+    ~RenderPool();
+
+    std::future<void> submit(std::function<void()> job);
+
+private:
+    typedef std::shared_ptr<std::packaged_task<void()>> Job;
+
+    BoundedQueue<Job> jobs;
+    std::vector<std::future<void>> workers;
+
+    void work();
+};
+
+#endif // RENDERPOOL_H
@@ -0,0 +1,75 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include "reportwriter.h"
+
+#include <QFile>
+#include <cstdio>
+
+ReportWriter::ReportWriter(const QString &skippedFilePath)
+    : skippedFilePath(skippedFilePath), items(4096) {
+    writer = std::async(std::launch::async, &ReportWriter::write, this);
+}
+
+ReportWriter::~ReportWriter() { finish(); }
+
+void ReportWriter::print(QByteArray text) {
+    Item item;
+    item.text = text; // Shared, not copied
+    if (!items.push(std::move(item))) {
+        // Already finished, nothing else is writing to the terminal then
+        fwrite(text.constData(), 1, text.size(), stdout);
+    }
+}
+
+void ReportWriter::addSkipped(const QString &filePath) {
+    Item item;
+    item.text = filePath.toUtf8() + "\n";
+    item.skipped = true;
+    items.push(std::move(item));
+}
+
+void ReportWriter::finish() {
+    items.close();
+    if (writer.valid()) {
+        writer.wait();
+    }
+    fflush(stdout);
+}
+
+void ReportWriter::write() {
+    QFile skippedFile(skippedFilePath);
+    std::deque<Item> batch;
+    while (items.popAll(batch)) {
+        bool skippedAdded = false;
+        for (const auto &item : batch) {
+            if (!item.skipped) {
+                fwrite(item.text.constData(), 1, item.text.size(), stdout);
+            } else if (skippedFile.isOpen() ||
+                       skippedFile.open(QIODevice::Append)) {
+                skippedFile.write(item.text);
+                skippedAdded = true;
+            }
+        }
+        batch.clear();
+        fflush(stdout);
+        if (skippedAdded) {
+            skippedFile.flush();
+        }
+    }
+}
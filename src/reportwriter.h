@@ -0,0 +1,58 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef REPORTWRITER_H
+#define REPORTWRITER_H
+
+#include "boundedqueue.h"
+
+#include <QByteArray>
+#include <QString>
+#include <future>
+
+/*
+ * Writes the per game report to the terminal and the names of skipped files
+ * to their log on a thread of its own, so Skyscraper::entryReady() never
+ * waits on either. Whatever has piled up is written in one go, in the order
+ * it was handed over.
+ */
+class ReportWriter {
+public:
+    explicit ReportWriter(const QString &skippedFilePath);
+    ~ReportWriter();
+
+    void print(QByteArray text);
+    void addSkipped(const QString &filePath);
+    // Waits until everything has been written. Call it before printing
+    // anything else to the terminal
+    void finish();
+
+private:
+    struct Item {
+        QByteArray text;
+        bool skipped = false;
+    };
+
+    QString skippedFilePath;
+    BoundedQueue<Item> items;
+    std::future<void> writer;
+
+    void write();
+};
+
+#endif // REPORTWRITER_H
@@ -0,0 +1,174 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include "retrypolicy.h"
+
+#include <QHash>
+#include <QMutexLocker>
+
+#if QT_VERSION >= 0x050a00
+#include <QRandomGenerator>
+#endif
+
+constexpr int MAXATTEMPTS = 4;
+constexpr int BASEDELAY = 1000;
+constexpr int MAXDELAY = 30000;
+constexpr int TRIPAFTER = 5;
+constexpr int MAXCOOLDOWN = 300000;
+// A probe that isn't recorded within this time is given up on
+constexpr int PROBETIMEOUT = 120000;
+constexpr double MAXBUDGET = 10.0;
+constexpr double BUDGETPERREQUEST = 0.2;
+
+RetryPolicy::Verdict RetryPolicy::classify(QNetworkReply::NetworkError error,
+                                           int httpStatus,
+                                           const QByteArray &) {
+    if (httpStatus == 429 || httpStatus == 503) {
+        return OVERLOADED;
+    }
+    if (httpStatus == 500 || httpStatus == 502 || httpStatus == 504) {
+        return RETRY;
+    }
+    switch (error) {
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::UnknownNetworkError:
+        return RETRY;
+    default:
+        return DONE;
+    }
+}
+
+QSharedPointer<RetryPolicy> RetryPolicy::get(const QString &host) {
+    static QMutex registryMutex;
+    static QHash<QString, QSharedPointer<RetryPolicy>> registry;
+    QMutexLocker locker(&registryMutex);
+    auto it = registry.constFind(host);
+    if (it != registry.constEnd()) {
+        return it.value();
+    }
+    QSharedPointer<RetryPolicy> policy(new RetryPolicy(host));
+    registry.insert(host, policy);
+    return policy;
+}
+
+RetryPolicy::RetryPolicy(const QString &host, const int baseCooldown)
+    : host(host), baseCooldown(baseCooldown), cooldown(baseCooldown),
+      budget(MAXBUDGET) {
+    clock.start();
+}
+
+void RetryPolicy::pass() {
+    QMutexLocker locker(&mutex);
+    while (state != CLOSED) {
+        if (state == OPEN) {
+            const qint64 left = openUntil - clock.elapsed();
+            if (left > 0) {
+                stateChanged.wait(&mutex, left);
+                continue;
+            }
+            state = HALF_OPEN;
+            probing = false;
+        }
+        if (!probing) {
+            probing = true;
+            return;
+        }
+        if (!stateChanged.wait(&mutex, PROBETIMEOUT)) {
+            probing = false;
+        }
+    }
+}
+
+bool RetryPolicy::tryPass() {
+    QMutexLocker locker(&mutex);
+    if (state == OPEN && openUntil - clock.elapsed() <= 0) {
+        state = HALF_OPEN;
+        probing = false;
+    }
+    if (state == CLOSED) {
+        return true;
+    }
+    if (state == HALF_OPEN && !probing) {
+        probing = true;
+        return true;
+    }
+    return false;
+}
+
+void RetryPolicy::record(const Verdict verdict) {
+    QMutexLocker locker(&mutex);
+    if (verdict == DONE) {
+        failures = 0;
+        budget = qMin(MAXBUDGET, budget + BUDGETPERREQUEST);
+        if (state != CLOSED) {
+            printf("\033[1;32mHost '%s' is answering again, resuming "
+                   "requests.\033[0m\n",
+                   host.toStdString().c_str());
+            state = CLOSED;
+            cooldown = baseCooldown;
+            probing = false;
+            stateChanged.wakeAll();
+        }
+        return;
+    }
+    ++failures;
+    if (verdict == OVERLOADED || failures >= TRIPAFTER || state == HALF_OPEN) {
+        trip();
+    }
+}
+
+// Must be called with 'mutex' locked
+void RetryPolicy::trip() {
+    printf("\033[1;33mHost '%s' seems to be overloaded, pausing requests to "
+           "it for %d seconds...\033[0m\n",
+           host.toStdString().c_str(), cooldown / 1000);
+    state = OPEN;
+    probing = false;
+    failures = 0;
+    openUntil = clock.elapsed() + cooldown;
+    cooldown = qMin(cooldown * 2, MAXCOOLDOWN);
+    stateChanged.wakeAll();
+}
+
+int RetryPolicy::retryDelay(const Verdict verdict, const int attempt,
+                            const int retryAfter) {
+    if (verdict == DONE || attempt + 1 >= MAXATTEMPTS) {
+        return -1;
+    }
+    QMutexLocker locker(&mutex);
+    if (budget < 1.0) {
+        return -1;
+    }
+    budget -= 1.0;
+    const int ceiling = qMin(MAXDELAY, BASEDELAY << attempt);
+    // Somewhere between half and all of the backoff, so threads failing
+    // together don't all come back at the same moment
+#if QT_VERSION >= 0x050a00
+    int delay = ceiling / 2 + QRandomGenerator::global()->bounded(ceiling / 2);
+#else
+    int delay = ceiling / 2 + qrand() % (ceiling / 2);
+#endif
+    if (retryAfter > 0) {
+        delay = qMax(delay, qMin(retryAfter * 1000, MAXCOOLDOWN));
+    }
+    return delay;
+}
@@ -0,0 +1,94 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef RETRYPOLICY_H
+#define RETRYPOLICY_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QNetworkReply>
+#include <QSharedPointer>
+#include <QString>
+#include <QWaitCondition>
+#include <functional>
+
+/*
+ * Decides for every host whether a failed request is sent again and when.
+ * Used by NetComm for all requests, so the scraping modules only have to say
+ * which responses are failures (see Classifier).
+ *
+ * Retries wait with exponential backoff and jitter, or as long as the server
+ * asks for with 'Retry-After'. Each host has a retry budget that grows by a
+ * fifth of a retry with every request that goes through, so a host that keeps
+ * failing doesn't get several times the requests.
+ *
+ * A host that says it's overloaded, or fails five times in a row, trips its
+ * circuit breaker. No requests are sent to it until a cooldown has passed,
+ * which doubles every time it trips again. Then a single request is let
+ * through to see whether the host has recovered while the others wait for it.
+ * All methods are thread safe.
+ */
+class RetryPolicy {
+public:
+    enum Verdict { DONE, RETRY, OVERLOADED };
+    typedef std::function<Verdict(QNetworkReply::NetworkError error,
+                                  int httpStatus, const QByteArray &data)>
+        Classifier;
+
+    // The classifier used unless a module sets its own. Module classifiers
+    // should fall back to it
+    static Verdict classify(QNetworkReply::NetworkError error, int httpStatus,
+                            const QByteArray &data);
+
+    // Returns the policy of 'host', creating it on first use
+    static QSharedPointer<RetryPolicy> get(const QString &host);
+
+    // 'baseCooldown' is the ms the circuit stays open when it first trips
+    explicit RetryPolicy(const QString &host, const int baseCooldown = 10000);
+
+    // Blocks while the circuit of the host is open
+    void pass();
+    // Same as pass(), but returns false instead of waiting
+    bool tryPass();
+    // Every request let through by pass() must be recorded
+    void record(const Verdict verdict);
+    // Ms to wait before sending the request of 'attempt' (counting from 0)
+    // again, or -1 if it shouldn't be
+    int retryDelay(const Verdict verdict, const int attempt,
+                   const int retryAfter = 0);
+
+private:
+    enum State { CLOSED, OPEN, HALF_OPEN };
+
+    const QString host;
+    const int baseCooldown;
+    State state = CLOSED;
+    bool probing = false;
+    int failures = 0;
+    int cooldown;
+    qint64 openUntil = 0;
+    double budget;
+    QElapsedTimer clock;
+    QMutex mutex;
+    QWaitCondition stateChanged;
+
+    void trip();
+};
+
+#endif // RETRYPOLICY_H
@@ -0,0 +1,498 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include "scrapepipeline.h"
+
+#include "compositor.h"
+#include "nametools.h"
+#include "strtools.h"
+
+#include <QDate>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QStringBuilder>
+#include <QThread>
+
+// How often the number of scraper threads is reconsidered with threads="auto"
+static const int TUNE_INTERVAL = 5000;
+// Share of the time the active scrapers may spend waiting on another stage
+// before some of them are parked
+static const double TUNE_WAIT_SHARE = 0.25;
+
+ScrapePipeline::ScrapePipeline(QSharedPointer<Queue> queue,
+                               QSharedPointer<Cache> cache,
+                               const Settings &config)
+    : queue(queue), cache(cache), config(config),
+      roms(config.threads * 2), results(QThread::idealThreadCount() * 2) {
+    cacheScraper = config.scraper == "cache";
+    connect(&tuneTimer, &QTimer::timeout, this, &ScrapePipeline::tune);
+}
+
+ScrapePipeline::~ScrapePipeline() {
+    releaseParked();
+    roms.close();
+    results.close();
+    for (auto &hasher : hashers) {
+        hasher.wait();
+    }
+    for (auto &persister : persisters) {
+        persister.wait();
+    }
+}
+
+void ScrapePipeline::start(const int scrapeThreads) {
+    const int cores = QThread::idealThreadCount();
+    // Hashing is mostly bound by the drive, a few threads keep ahead of the
+    // scrapers. Persisting resizes images for the cache, which can use every
+    // core. Artwork is rendered on a pool of its own that has every core too
+    const int hashThreads = qBound(1, cores / 2, 4);
+    const int persistThreads = qMax(1, cores);
+    if (cacheScraper && !config.pretend) {
+        renderPool = QSharedPointer<RenderPool>(new RenderPool(cores));
+    }
+    hashersLeft = hashThreads;
+    scrapersLeft = scrapeThreads;
+    persistersLeft = persistThreads;
+    maxScrapers = scrapeThreads;
+    if (config.threadsAuto) {
+        // Start low, tune() adds threads for as long as it pays off
+        activeScrapers = qMin(2, scrapeThreads);
+        lastActive = activeScrapers;
+        tuneTimer.start(TUNE_INTERVAL);
+    } else {
+        activeScrapers = scrapeThreads;
+    }
+    for (int a = 0; a < hashThreads; ++a) {
+        hashers.push_back(
+            std::async(std::launch::async, &ScrapePipeline::hashRoms, this));
+    }
+    for (int a = 0; a < persistThreads; ++a) {
+        persisters.push_back(std::async(std::launch::async,
+                                        &ScrapePipeline::persistResults, this));
+    }
+}
+
+bool ScrapePipeline::takeRom(PreparedRom &rom, const int worker) {
+    waitIfParked(worker);
+    // Roms already hashed are dropped as well once the run is cancelled
+    if (queue->isCancelled()) {
+        return false;
+    }
+    QElapsedTimer waited;
+    waited.start();
+    const bool taken = roms.pop(rom);
+    scrapeIdleNs += waited.nsecsElapsed();
+    return taken;
+}
+
+void ScrapePipeline::addResult(ScrapeResult result) {
+    QElapsedTimer waited;
+    waited.start();
+    results.push(std::move(result));
+    scrapeBlockedNs += waited.nsecsElapsed();
+    ++scraped;
+}
+
+void ScrapePipeline::scraperDone() {
+    if (--scrapersLeft == 0) {
+        // Nothing will be scraped anymore. Stop hashing and let the persist
+        // stage finish what it has
+        roms.close();
+        results.close();
+    }
+}
+
+void ScrapePipeline::hashRoms() {
+    PreparedRom rom;
+    while (queue->takeEntry(rom.info)) {
+        rom.cacheId = cache->getQuickId(rom.info);
+        if (rom.cacheId.isEmpty()) {
+            rom.cacheId = NameTools::getCacheId(rom.info);
+            cache->addQuickId(rom.info, rom.cacheId);
+        }
+        if (!roms.push(rom)) {
+            break;
+        }
+    }
+    if (--hashersLeft == 0) {
+        roms.close();
+        // Nothing left to tune, let every scraper see the end of the queue
+        releaseParked();
+    }
+}
+
+void ScrapePipeline::waitIfParked(const int worker) {
+    QMutexLocker locker(&parkMutex);
+    while (!parkingReleased && worker > activeScrapers) {
+        unparked.wait(&parkMutex);
+    }
+}
+
+void ScrapePipeline::releaseParked() {
+    QMutexLocker locker(&parkMutex);
+    parkingReleased = true;
+    unparked.wakeAll();
+}
+
+// Hill climbing on the number of roms scraped per interval. Threads are added
+// for as long as throughput goes up and taken away again when it doesn't.
+// Scrapers waiting on the hash stage for roms or on the persist stage to take
+// their results are a sign of too many of them, so some are parked then
+void ScrapePipeline::tune() {
+    int active = 0;
+    {
+        QMutexLocker locker(&parkMutex);
+        if (parkingReleased) {
+            tuneTimer.stop();
+            return;
+        }
+        const int done = scraped.exchange(0);
+        const double available =
+            (double)TUNE_INTERVAL * 1000000.0 * activeScrapers;
+        const double idleShare = scrapeIdleNs.exchange(0) / available;
+        const double blockedShare = scrapeBlockedNs.exchange(0) / available;
+
+        int next = activeScrapers;
+        if (idleShare > TUNE_WAIT_SHARE || blockedShare > TUNE_WAIT_SHARE) {
+            next = activeScrapers - 1;
+            tuneHold = 2;
+        } else if (lastActive < activeScrapers && done <= lastScraped) {
+            // The last step up didn't pay off. Most likely the scraping source
+            // or the drive is the limit now
+            next = lastActive;
+            tuneHold = 3;
+        } else if (tuneHold > 0) {
+            --tuneHold;
+        } else {
+            next = activeScrapers + qMax(1, activeScrapers / 2);
+        }
+        next = qBound(1, next, maxScrapers);
+
+        lastScraped = done;
+        lastActive = activeScrapers;
+        if (next == activeScrapers) {
+            return;
+        }
+        activeScrapers = next;
+        unparked.wakeAll();
+        active = next;
+    }
+    emit threadsTuned(active, maxScrapers);
+}
+
+void ScrapePipeline::persistResults() {
+    Compositor compositor(&config);
+    if (!compositor.processXml()) {
+        printf("Something went wrong when parsing artwork xml from '%s', "
+               "please check the file for errors. Now exiting...\n",
+               config.artworkConfig.toStdString().c_str());
+        exit(1);
+    }
+    compositor.setRenderPool(renderPool.data());
+
+    ScrapeResult result;
+    while (results.pop(result)) {
+        if (result.persist) {
+            persist(result, compositor);
+        }
+        emit entryReady(QSharedPointer<ScrapeResult>(
+            new ScrapeResult(std::move(result))));
+    }
+
+    if (--persistersLeft == 0) {
+        // Make sure no quick ids are added while the cache is being written
+        for (auto &hasher : hashers) {
+            hasher.wait();
+        }
+        emit allDone();
+    }
+}
+
+void ScrapePipeline::persist(ScrapeResult &result, Compositor &compositor) {
+    GameEntry &game = result.game;
+    const QFileInfo &info = result.info;
+    const bool fromCache = result.fromCache;
+
+    if (!config.pretend && cacheScraper) {
+        // Process all artwork
+        compositor.saveAll(game, info.completeBaseName());
+        // extra media files (not part of compositor)
+        const QString baseName = info.completeBaseName();
+        const QString subPath = compositor.getSubpath(game.path);
+        copyMedia("video", baseName, subPath, game);
+        copyMedia("manual", baseName, subPath, game);
+    }
+
+    // Add all resources to the cache
+    QString cacheOutput = "";
+    if (!cacheScraper && game.found && !fromCache) {
+        game.source = config.scraper;
+        cache->addResources(game, config, cacheOutput);
+    }
+
+    // We're done saving the raw data at this point, so feel free to
+    // manipulate game resources to better suit game list creation from here
+    // on out.
+
+    // Strip any brackets from the title as they will be re-added when
+    // assembling gamelist
+    game.title = StrTools::stripBrackets(game.title);
+
+    // Move 'The' or ', The' depending on the config. This does not affect
+    // game list sorting. 'The ' is always removed before sorting.
+    if (config.theInFront) {
+        QRegularExpression theMatch(", [Tt]{1}he");
+        if (theMatch.match(game.title).hasMatch()) {
+            game.title.replace(theMatch.match(game.title).captured(0), "");
+            game.title.prepend("The ");
+        }
+    } else {
+        if (game.title.toLower().left(4) == "the ") {
+            game.title = game.title.remove(0, 4).simplified().append(", The");
+        }
+    }
+
+    // Don't unescape title since we already did that in getBestEntry()
+    game.videoFile = StrTools::xmlUnescape(config.videosFolder + "/" +
+                                           info.completeBaseName() + "." +
+                                           game.videoFormat);
+    game.manualFile = StrTools::xmlUnescape(
+        config.manualsFolder + "/" + info.completeBaseName() + ".pdf");
+    game.description = StrTools::xmlUnescape(game.description);
+    if (config.tidyDesc) {
+        bool skipBangs = game.title.contains("!!");
+        game.description = StrTools::tidyText(game.description, skipBangs);
+    }
+    game.releaseDate = StrTools::xmlUnescape(game.releaseDate);
+    // Make sure we have the correct 'yyyymmdd' format of 'releaseDate'
+    game.releaseDate = StrTools::conformReleaseDate(game.releaseDate);
+    game.developer = StrTools::xmlUnescape(game.developer);
+    game.publisher = StrTools::xmlUnescape(game.publisher);
+    game.tags = StrTools::xmlUnescape(game.tags);
+    game.tags = StrTools::conformTags(game.tags);
+    game.rating = StrTools::xmlUnescape(game.rating);
+    game.players = StrTools::xmlUnescape(game.players);
+    // Make sure we have the correct single digit format of 'players'
+    game.players = StrTools::conformPlayers(game.players);
+    game.ages = StrTools::xmlUnescape(game.ages);
+    // Make sure we have the correct format of 'ages'
+    game.ages = StrTools::conformAges(game.ages);
+
+    // The title as found, before applying 'nameTemplate' and the like
+    const QString resultTitle = game.title;
+    if (!config.nameTemplate.isEmpty()) {
+        game.title = StrTools::xmlUnescape(
+            NameTools::getNameFromTemplate(game, config.nameTemplate));
+    } else {
+        game.title = StrTools::xmlUnescape(game.title);
+        if (config.forceFilename) {
+            game.title = StrTools::xmlUnescape(
+                StrTools::stripBrackets(info.completeBaseName()));
+        }
+        if (config.brackets) {
+            game.title.append(StrTools::xmlUnescape(
+                (game.parNotes != "" ? " " + game.parNotes : "") +
+                (game.sqrNotes != "" ? " " + game.sqrNotes : "")));
+        }
+    }
+    if (!config.quiet) {
+        appendReport(result, resultTitle, cacheOutput);
+    }
+    game.calculateCompleteness(config.videos, config.manuals);
+    game.resetMedia();
+}
+
+// Adds the details of a game to the terminal output. Skipped altogether with
+// 'quiet', which only shows the progress
+void ScrapePipeline::appendReport(ScrapeResult &result,
+                                  const QString &resultTitle,
+                                  const QString &cacheOutput) {
+    const GameEntry &game = result.game;
+    QString &output = result.output;
+
+    output.append("Scraper:        " + config.scraper + "\n");
+    if (!cacheScraper && config.scraper != "import") {
+        output.append(
+            "From cache:     " +
+            QString(
+                (result.fromCache
+                     ? "YES (refresh from source with '--cache refresh')"
+                     : "NO")) +
+            "\n");
+        output.append("Search match:   " + QString::number(game.searchMatch) +
+                      " %\n");
+        output.append("Compare title:  '\033[1;32m" + result.compareTitle +
+                      "\033[0m'\n");
+        output.append("Result title:   '\033[1;32m" + resultTitle +
+                      "\033[0m' (" + game.titleSrc + ")\n");
+    } else {
+        output.append("Title:          '\033[1;32m" + resultTitle +
+                      "\033[0m' (" + game.titleSrc + ")\n");
+    }
+    output.append("Platform:       '\033[1;32m" + game.platform +
+                  "\033[0m' (" + game.platformSrc + ")\n");
+    output.append("Release Date:   '\033[1;32m");
+    if (game.releaseDate.isEmpty()) {
+        output.append("\033[0m' ()\n");
+    } else {
+        output.append(QDate::fromString(game.releaseDate, "yyyyMMdd")
+                          .toString("yyyy-MM-dd") +
+                      "\033[0m' (" + game.releaseDateSrc + ")\n");
+    }
+    output.append("Developer:      '\033[1;32m" + game.developer +
+                  "\033[0m' (" + game.developerSrc + ")\n");
+    output.append("Publisher:      '\033[1;32m" + game.publisher +
+                  "\033[0m' (" + game.publisherSrc + ")\n");
+    output.append("Players:        '\033[1;32m" + game.players +
+                  "\033[0m' (" + game.playersSrc + ")\n");
+    output.append("Ages:           '\033[1;32m" + game.ages +
+                  (game.ages.toInt() != 0 ? "+" : "") + "\033[0m' (" +
+                  game.agesSrc + ")\n");
+    output.append("Tags:           '\033[1;32m" + game.tags + "\033[0m' (" +
+                  game.tagsSrc + ")\n");
+    output.append("Rating (0-1):   '\033[1;32m" + game.rating +
+                  "\033[0m' (" + game.ratingSrc + ")\n");
+    output.append(
+        "Cover:          " +
+        QString(
+            (game.coverData.isNull() ? "\033[1;31mNO" : "\033[1;32mYES")) +
+        "\033[0m" +
+        QString((config.cacheCovers || cacheScraper ? "" : " (uncached)")) +
+        " (" + game.coverSrc + ")\n");
+    output.append(
+        "Screenshot:     " +
+        QString((game.screenshotData.isNull() ? "\033[1;31mNO"
+                                              : "\033[1;32mYES")) +
+        "\033[0m" +
+        QString((config.cacheScreenshots || cacheScraper ? ""
+                                                         : " (uncached)")) +
+        " (" + game.screenshotSrc + ")\n");
+    output.append(
+        "Wheel:          " +
+        QString(
+            (game.wheelData.isNull() ? "\033[1;31mNO" : "\033[1;32mYES")) +
+        "\033[0m" +
+        QString((config.cacheWheels || cacheScraper ? "" : " (uncached)")) +
+        " (" + game.wheelSrc + ")\n");
+    output.append(
+        "Marquee:        " +
+        QString((game.marqueeData.isNull() ? "\033[1;31mNO"
+                                           : "\033[1;32mYES")) +
+        "\033[0m" +
+        QString(
+            (config.cacheMarquees || cacheScraper ? "" : " (uncached)")) +
+        " (" + game.marqueeSrc + ")\n");
+    output.append(
+        "Texture:        " +
+        QString((game.textureData.isNull() ? "\033[1;31mNO"
+                                           : "\033[1;32mYES")) +
+        "\033[0m" +
+        QString(
+            (config.cacheTextures || cacheScraper ? "" : " (uncached)")) +
+        " (" + game.textureSrc + ")\n");
+    if (config.videos) {
+        // Streamed and cached videos are never loaded into 'videoData'
+        const qint64 videoSize = game.videoData.isEmpty()
+                                     ? game.videoSize
+                                     : game.videoData.size();
+        output.append(
+            "Video:          " +
+            QString((game.videoFormat.isEmpty() ? "\033[1;31mNO"
+                                                : "\033[1;32mYES")) +
+            "\033[0m" +
+            QString((videoSize <= config.videoSizeLimit
+                         ? ""
+                         : " (size exceeded, uncached)")) +
+            " (" + game.videoSrc + ")\n");
+    }
+    if (config.manuals) {
+        output.append(
+            "Manual:         " +
+            QString((game.manualData.isEmpty() && game.manualSize == 0
+                         ? "\033[1;31mNO"
+                         : "\033[1;32mYES")) +
+            "\033[0m (" + game.manualSrc + ")\n");
+    }
+    output.append("\nDescription: (" + game.descriptionSrc +
+                  ")\n'\033[1;32m" +
+                  game.description.left(config.maxLength) + "\033[0m'\n");
+    if (!cacheOutput.isEmpty()) {
+        output.append("\n\033[1;33mCache output:\033[0m\n" + cacheOutput +
+                      "\n");
+    }
+    output.append(result.outputTail);
+}
+
+void ScrapePipeline::copyMedia(const QString &mediaType,
+                               const QString &completeBaseName,
+                               const QString &subPath, GameEntry &game) {
+
+    // false means "game manual"
+    const bool isVideoType = mediaType == "video";
+
+    const QString fmt = isVideoType ? game.videoFormat : "pdf";
+    // Path to the file in the resource cache as set by Cache::fillBlanks()
+    const QString fn = isVideoType ? game.videoFile : game.manualFile;
+    const bool mediaTypeEnabled = isVideoType ? config.videos : config.manuals;
+    const bool skipExisting =
+        isVideoType ? config.skipExistingVideos : config.skipExistingManuals;
+    const QString mediaTypeFolder =
+        isVideoType ? config.videosFolder : config.manualsFolder;
+
+    bool noCopy = true;
+    if (mediaTypeEnabled && fmt != "" && !fn.isEmpty() && QFile::exists(fn)) {
+        QString absMediaFn = completeBaseName % "." % fmt;
+        if (subPath != ".") {
+            absMediaFn = subPath % "/" % absMediaFn;
+            QFileInfo fi = QFileInfo(mediaTypeFolder % "/" % absMediaFn);
+            if (!QDir().mkpath(fi.absolutePath())) {
+                qWarning() << "Path could not be created" << fi.absolutePath()
+                           << " Check file permissions, gamelist binary data "
+                              "maybe incomplete.";
+            }
+        }
+        absMediaFn = mediaTypeFolder % "/" % absMediaFn;
+
+        if (!(skipExisting && QFile::exists(absMediaFn))) {
+            QFile::remove(absMediaFn);
+            if (config.symlink && isVideoType) {
+                // symlink
+                if (QFile::link(fn, absMediaFn)) {
+                    noCopy = false;
+                }
+            } else {
+                // copy, file contents never pass through memory here
+                if (QFile::copy(fn, absMediaFn)) {
+                    noCopy = false;
+                }
+            }
+        }
+    }
+    if (noCopy) {
+        if (isVideoType) {
+            game.videoFormat = "";
+            game.videoSize = 0;
+        } else {
+            game.manualData = QByteArray();
+            game.manualFile = "";
+            game.manualSize = 0;
+        }
+    }
+}
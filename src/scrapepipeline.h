@@ -0,0 +1,149 @@
+/*
+ *  This file is part of skyscraper.
+ *
+ *  skyscraper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  skyscraper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with skyscraper; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef SCRAPEPIPELINE_H
+#define SCRAPEPIPELINE_H
+
+#include "boundedqueue.h"
+#include "cache.h"
+#include "gameentry.h"
+#include "queue.h"
+#include "renderpool.h"
+#include "settings.h"
+
+#include <QFileInfo>
+#include <QMutex>
+#include <QObject>
+#include <QSharedPointer>
+#include <QTimer>
+#include <QWaitCondition>
+#include <atomic>
+#include <future>
+#include <vector>
+
+class Compositor;
+
+// A rom with its cacheId worked out, handed to the scraper workers
+struct PreparedRom {
+    QFileInfo info;
+    QString cacheId;
+};
+
+// The outcome of scraping a single rom, handed to the persist stage
+struct ScrapeResult {
+    GameEntry game;
+    QFileInfo info;
+    QString compareTitle;
+    QString output;
+    QString debug;
+    // Appended after everything else, such as the requests remaining
+    QString outputTail;
+    bool fromCache = false;
+    // Not found or skipped entries are only reported
+    bool persist = false;
+};
+Q_DECLARE_METATYPE(QSharedPointer<ScrapeResult>)
+
+/*
+ * Runs a scraping run as three stages connected by bounded queues:
+ *
+ *   hash     takes roms from the file queue and works out their cacheId,
+ *            which means reading the whole file for roms not seen before
+ *   scrape   the ScraperWorker threads, searching and fetching from the
+ *            scraping source (see ScraperWorker::run())
+ *   persist  adds the results to the cache, renders artwork when generating
+ *            a game list and reports each entry through entryReady(). The
+ *            artwork itself is rendered on a RenderPool
+ *
+ * Each stage has its own number of threads, so a rom being hashed or having
+ * its media converted doesn't hold up a thread waiting on the network.
+ *
+ * With threads="auto" all scraper threads are started, but only some of them
+ * take roms while the rest are parked. How many is tuned while running from
+ * the throughput and the time the scrapers spend waiting on the stages before
+ * and after them (see tune()).
+ */
+class ScrapePipeline : public QObject {
+    Q_OBJECT
+
+public:
+    ScrapePipeline(QSharedPointer<Queue> queue, QSharedPointer<Cache> cache,
+                   const Settings &config);
+    ~ScrapePipeline();
+
+    void start(const int scrapeThreads);
+
+    // Used by the ScraperWorker threads. 'worker' counts from 1
+    bool takeRom(PreparedRom &rom, const int worker);
+    void addResult(ScrapeResult result);
+    void scraperDone();
+
+signals:
+    // Only the pointer is copied into the queued connection, the result is
+    // handed over as a whole
+    void entryReady(QSharedPointer<ScrapeResult> result);
+    void allDone();
+    void threadsTuned(int active, int max);
+
+private slots:
+    void tune();
+
+private:
+    QSharedPointer<Queue> queue;
+    QSharedPointer<Cache> cache;
+    Settings config;
+    bool cacheScraper = false;
+
+    BoundedQueue<PreparedRom> roms;
+    BoundedQueue<ScrapeResult> results;
+    std::vector<std::future<void>> hashers;
+    std::vector<std::future<void>> persisters;
+    QSharedPointer<RenderPool> renderPool;
+    std::atomic<int> hashersLeft{0};
+    std::atomic<int> scrapersLeft{0};
+    std::atomic<int> persistersLeft{0};
+
+    // Scraper threads allowed to take roms, the rest wait in takeRom()
+    QMutex parkMutex;
+    QWaitCondition unparked;
+    int activeScrapers = 0;
+    int maxScrapers = 0;
+    bool parkingReleased = false;
+
+    // Measured by the scrapers and sampled by tune()
+    QTimer tuneTimer;
+    std::atomic<qint64> scrapeIdleNs{0};
+    std::atomic<qint64> scrapeBlockedNs{0};
+    std::atomic<int> scraped{0};
+    int lastScraped = -1;
+    int lastActive = 0;
+    int tuneHold = 0;
+
+    void waitIfParked(const int worker);
+    void releaseParked();
+
+    void hashRoms();
+    void persistResults();
+    void persist(ScrapeResult &result, Compositor &compositor);
+    void appendReport(ScrapeResult &result, const QString &resultTitle,
+                      const QString &cacheOutput);
+    void copyMedia(const QString &mediaType, const QString &completeBaseName,
+                   const QString &subPath, GameEntry &game);
+};
+
+#endif // SCRAPEPIPELINE_H
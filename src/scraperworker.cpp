@@ -26,7 +26,6 @@
 #include "scraperworker.h"
 
 #include "arcadedb.h"
-#include "compositor.h"
 #include "esgamelist.h"
 #include "gameentry.h"
 #include "igdb.h"
@@ -49,16 +48,16 @@
 
 constexpr int UNDEF_YEAR = -1;
 
-ScraperWorker::ScraperWorker(QSharedPointer<Queue> queue,
+ScraperWorker::ScraperWorker(QSharedPointer<ScrapePipeline> pipeline,
                              QSharedPointer<Cache> cache,
-                             QSharedPointer<NetManager> manager,
                              Settings config, QString threadId)
-    : config(config), cache(cache), manager(manager), queue(queue),
-      threadId(threadId) {}
+    : config(config), cache(cache), pipeline(pipeline), threadId(threadId) {}
 
 ScraperWorker::~ScraperWorker() {}
 
 void ScraperWorker::run() {
+    manager = QSharedPointer<NetManager>(
+        new NetManager(config.connectionsPerHost));
     bool cacheScraper = false;
     if (config.scraper == "openretro") {
         scraper = new OpenRetro(&config, manager);
@@ -90,27 +89,15 @@ void ScraperWorker::run() {
     }
     platformOrig = config.platform;
 
-    Compositor compositor(&config);
-    if (!compositor.processXml()) {
-        printf("Something went wrong when parsing artwork xml from '%s', "
-               "please check the file for errors. Now exiting...\n",
-               config.artworkConfig.toStdString().c_str());
-        exit(1);
-    }
-
-    while (queue->hasEntry()) {
-        // takeEntry() also unlocks the mutex that was locked in hasEntry()
-        QFileInfo info = queue->takeEntry();
+    PreparedRom rom;
+    while (pipeline->takeRom(rom, threadId.toInt())) {
+        const QFileInfo &info = rom.info;
+        const QString &cacheId = rom.cacheId;
         // Reset platform in case we have manipulated it (such as changing
         // 'amiga' to 'cd32')
         config.platform = platformOrig;
         QString output = "\033[1;33m(T" + threadId + ")\033[0m ";
         QString debug = "";
-        QString cacheId = cache->getQuickId(info);
-        if (cacheId.isEmpty()) {
-            cacheId = NameTools::getCacheId(info);
-            cache->addQuickId(info, cacheId);
-        }
 
         // compareTitle is what SkyScraper uses as the title internally and with
         // cache, distinctly separate from search query and/or result from a
@@ -160,7 +147,7 @@ void ScraperWorker::run() {
                 "\033[1;33m---- Skipping game '" + info.completeBaseName() +
                 "' since 'onlymissing' flag has been set ----\033[0m\n\n");
             game.resetMedia();
-            emit entryReady(game, output, debug);
+            report(game, output, debug);
             if (forceEnd) {
                 break;
             } else {
@@ -245,7 +232,7 @@ void ScraperWorker::run() {
             if (!forceEnd) {
                 forceEnd = limitReached(output);
             }
-            emit entryReady(game, output, debug);
+            report(game, output, debug);
             if (forceEnd) {
                 break;
             } else {
@@ -264,7 +251,7 @@ void ScraperWorker::run() {
             if (!forceEnd) {
                 forceEnd = limitReached(output);
             }
-            emit entryReady(game, output, debug);
+            report(game, output, debug);
             if (forceEnd) {
                 break;
             } else {
@@ -279,205 +266,26 @@ void ScraperWorker::run() {
             scraper->getGameData(game);
         }
 
-        if (!config.pretend && cacheScraper) {
-            // Process all artwork
-            compositor.saveAll(game, info.completeBaseName());
-            // extra media files (not part of compositor)
-            const QString baseName = info.completeBaseName();
-            const QString subPath = compositor.getSubpath(game.path);
-            copyMedia("video", baseName, subPath, game);
-            copyMedia("manual", baseName, subPath, game);
-        }
-
-        // Add all resources to the cache
-        QString cacheOutput = "";
-        if (!cacheScraper && game.found && !fromCache) {
-            game.source = config.scraper;
-            cache->addResources(game, config, cacheOutput);
-        }
-
-        // We're done saving the raw data at this point, so feel free to
-        // manipulate game resources to better suit game list creation from here
-        // on out.
-
-        // Strip any brackets from the title as they will be re-added when
-        // assembling gamelist
-        game.title = StrTools::stripBrackets(game.title);
-
-        // Move 'The' or ', The' depending on the config. This does not affect
-        // game list sorting. 'The ' is always removed before sorting.
-        if (config.theInFront) {
-            QRegularExpression theMatch(", [Tt]{1}he");
-            if (theMatch.match(game.title).hasMatch()) {
-                game.title.replace(theMatch.match(game.title).captured(0), "");
-                game.title.prepend("The ");
-            }
-        } else {
-            if (game.title.toLower().left(4) == "the ") {
-                game.title =
-                    game.title.remove(0, 4).simplified().append(", The");
-            }
-        }
-
-        // Don't unescape title since we already did that in getBestEntry()
-        game.videoFile = StrTools::xmlUnescape(config.videosFolder + "/" +
-                                               info.completeBaseName() + "." +
-                                               game.videoFormat);
-        game.manualFile = StrTools::xmlUnescape(
-            config.manualsFolder + "/" + info.completeBaseName() + ".pdf");
-        game.description = StrTools::xmlUnescape(game.description);
-        if (config.tidyDesc) {
-            bool skipBangs = game.title.contains("!!");
-            game.description = StrTools::tidyText(game.description, skipBangs);
-        }
-        game.releaseDate = StrTools::xmlUnescape(game.releaseDate);
-        // Make sure we have the correct 'yyyymmdd' format of 'releaseDate'
-        game.releaseDate = StrTools::conformReleaseDate(game.releaseDate);
-        game.developer = StrTools::xmlUnescape(game.developer);
-        game.publisher = StrTools::xmlUnescape(game.publisher);
-        game.tags = StrTools::xmlUnescape(game.tags);
-        game.tags = StrTools::conformTags(game.tags);
-        game.rating = StrTools::xmlUnescape(game.rating);
-        game.players = StrTools::xmlUnescape(game.players);
-        // Make sure we have the correct single digit format of 'players'
-        game.players = StrTools::conformPlayers(game.players);
-        game.ages = StrTools::xmlUnescape(game.ages);
-        // Make sure we have the correct format of 'ages'
-        game.ages = StrTools::conformAges(game.ages);
-
-        output.append("Scraper:        " + config.scraper + "\n");
-        if (!cacheScraper && config.scraper != "import") {
-            output.append(
-                "From cache:     " +
-                QString(
-                    (fromCache
-                         ? "YES (refresh from source with '--cache refresh')"
-                         : "NO")) +
-                "\n");
-            output.append("Search match:   " + QString::number(searchMatch) +
-                          " %\n");
-            output.append("Compare title:  '\033[1;32m" + compareTitle +
-                          "\033[0m'\n");
-            output.append("Result title:   '\033[1;32m" + game.title +
-                          "\033[0m' (" + game.titleSrc + ")\n");
-        } else {
-            output.append("Title:          '\033[1;32m" + game.title +
-                          "\033[0m' (" + game.titleSrc + ")\n");
-        }
-        if (!config.nameTemplate.isEmpty()) {
-            game.title = StrTools::xmlUnescape(
-                NameTools::getNameFromTemplate(game, config.nameTemplate));
-        } else {
-            game.title = StrTools::xmlUnescape(game.title);
-            if (config.forceFilename) {
-                game.title = StrTools::xmlUnescape(
-                    StrTools::stripBrackets(info.completeBaseName()));
-            }
-            if (config.brackets) {
-                game.title.append(StrTools::xmlUnescape(
-                    (game.parNotes != "" ? " " + game.parNotes : "") +
-                    (game.sqrNotes != "" ? " " + game.sqrNotes : "")));
-            }
-        }
-        output.append("Platform:       '\033[1;32m" + game.platform +
-                      "\033[0m' (" + game.platformSrc + ")\n");
-        output.append("Release Date:   '\033[1;32m");
-        if (game.releaseDate.isEmpty()) {
-            output.append("\033[0m' ()\n");
-        } else {
-            output.append(QDate::fromString(game.releaseDate, "yyyyMMdd")
-                              .toString("yyyy-MM-dd") +
-                          "\033[0m' (" + game.releaseDateSrc + ")\n");
-        }
-        output.append("Developer:      '\033[1;32m" + game.developer +
-                      "\033[0m' (" + game.developerSrc + ")\n");
-        output.append("Publisher:      '\033[1;32m" + game.publisher +
-                      "\033[0m' (" + game.publisherSrc + ")\n");
-        output.append("Players:        '\033[1;32m" + game.players +
-                      "\033[0m' (" + game.playersSrc + ")\n");
-        output.append("Ages:           '\033[1;32m" + game.ages +
-                      (game.ages.toInt() != 0 ? "+" : "") + "\033[0m' (" +
-                      game.agesSrc + ")\n");
-        output.append("Tags:           '\033[1;32m" + game.tags + "\033[0m' (" +
-                      game.tagsSrc + ")\n");
-        output.append("Rating (0-1):   '\033[1;32m" + game.rating +
-                      "\033[0m' (" + game.ratingSrc + ")\n");
-        output.append(
-            "Cover:          " +
-            QString(
-                (game.coverData.isNull() ? "\033[1;31mNO" : "\033[1;32mYES")) +
-            "\033[0m" +
-            QString((config.cacheCovers || cacheScraper ? "" : " (uncached)")) +
-            " (" + game.coverSrc + ")\n");
-        output.append(
-            "Screenshot:     " +
-            QString((game.screenshotData.isNull() ? "\033[1;31mNO"
-                                                  : "\033[1;32mYES")) +
-            "\033[0m" +
-            QString((config.cacheScreenshots || cacheScraper ? ""
-                                                             : " (uncached)")) +
-            " (" + game.screenshotSrc + ")\n");
-        output.append(
-            "Wheel:          " +
-            QString(
-                (game.wheelData.isNull() ? "\033[1;31mNO" : "\033[1;32mYES")) +
-            "\033[0m" +
-            QString((config.cacheWheels || cacheScraper ? "" : " (uncached)")) +
-            " (" + game.wheelSrc + ")\n");
-        output.append(
-            "Marquee:        " +
-            QString((game.marqueeData.isNull() ? "\033[1;31mNO"
-                                               : "\033[1;32mYES")) +
-            "\033[0m" +
-            QString(
-                (config.cacheMarquees || cacheScraper ? "" : " (uncached)")) +
-            " (" + game.marqueeSrc + ")\n");
-        output.append(
-            "Texture:        " +
-            QString((game.textureData.isNull() ? "\033[1;31mNO"
-                                               : "\033[1;32mYES")) +
-            "\033[0m" +
-            QString(
-                (config.cacheTextures || cacheScraper ? "" : " (uncached)")) +
-            " (" + game.textureSrc + ")\n");
-        if (config.videos) {
-            output.append(
-                "Video:          " +
-                QString((game.videoFormat.isEmpty() ? "\033[1;31mNO"
-                                                    : "\033[1;32mYES")) +
-                "\033[0m" +
-                QString((game.videoData.size() <= config.videoSizeLimit
-                             ? ""
-                             : " (size exceeded, uncached)")) +
-                " (" + game.videoSrc + ")\n");
-        }
-        if (config.manuals) {
-            output.append(
-                "Manual:         " +
-                QString((game.manualData.isEmpty() ? "\033[1;31mNO"
-                                                   : "\033[1;32mYES")) +
-                "\033[0m (" + game.manualSrc + ")\n");
-        }
-        output.append("\nDescription: (" + game.descriptionSrc +
-                      ")\n'\033[1;32m" +
-                      game.description.left(config.maxLength) + "\033[0m'\n");
-        if (!cacheOutput.isEmpty()) {
-            output.append("\n\033[1;33mCache output:\033[0m\n" + cacheOutput +
-                          "\n");
-        }
+        // Adding to the cache and the output happens in the persist stage
+        ScrapeResult result;
+        result.info = info;
+        result.compareTitle = compareTitle;
+        result.fromCache = fromCache;
+        result.persist = true;
         if (!forceEnd) {
-            forceEnd = limitReached(output);
+            forceEnd = limitReached(result.outputTail);
         }
-        game.calculateCompleteness(config.videos, config.manuals);
-        game.resetMedia();
-        emit entryReady(game, output, debug);
+        result.game = std::move(game);
+        result.output = std::move(output);
+        result.debug = std::move(debug);
+        pipeline->addResult(std::move(result));
         if (forceEnd) {
             break;
         }
     }
 
     scraper->deleteLater();
-    emit allDone();
+    pipeline->scraperDone();
 }
 
 bool ScraperWorker::limitReached(QString &output) {
@@ -495,6 +303,15 @@ bool ScraperWorker::limitReached(QString &output) {
     return false;
 }
 
+// Entries that weren't found or were skipped pass the persist stage untouched
+void ScraperWorker::report(GameEntry &game, QString &output, QString &debug) {
+    ScrapeResult result;
+    result.game = std::move(game);
+    result.output = std::move(output);
+    result.debug = std::move(debug);
+    pipeline->addResult(std::move(result));
+}
+
 int ScraperWorker::getSearchMatch(const QString &title,
                                   const QString &compareTitle,
                                   const int &lowestDistance) {
@@ -794,64 +611,6 @@ GameEntry ScraperWorker::getEntryFromUser(const QList<GameEntry> &gameEntries,
     return suggestedGame;
 }
 
-void ScraperWorker::copyMedia(const QString &mediaType,
-                              const QString &completeBaseName,
-                              const QString &subPath, GameEntry &game) {
-
-    // false means "game manual"
-    const bool isVideoType = mediaType == "video";
-
-    const QString fmt = isVideoType ? game.videoFormat : "pdf";
-    const QString fn = isVideoType ? game.videoFile : game.manualFile;
-    const QByteArray data = isVideoType ? game.videoData : game.manualData;
-    const bool mediaTypeEnabled = isVideoType ? config.videos : config.manuals;
-    const bool skipExisting =
-        isVideoType ? config.skipExistingVideos : config.skipExistingManuals;
-    const QString mediaTypeFolder =
-        isVideoType ? config.videosFolder : config.manualsFolder;
-
-    bool noCopy = true;
-    if (mediaTypeEnabled && fmt != "" && !fn.isEmpty() && QFile::exists(fn)) {
-        QString absMediaFn = completeBaseName % "." % fmt;
-        if (subPath != ".") {
-            absMediaFn = subPath % "/" % absMediaFn;
-            QFileInfo fi = QFileInfo(mediaTypeFolder % "/" % absMediaFn);
-            if (!QDir().mkpath(fi.absolutePath())) {
-                qWarning() << "Path could not be created" << fi.absolutePath()
-                           << " Check file permissions, gamelist binary data "
-                              "maybe incomplete.";
-            }
-        }
-        absMediaFn = mediaTypeFolder % "/" % absMediaFn;
-
-        if (!(skipExisting && QFile::exists(absMediaFn))) {
-            QFile::remove(absMediaFn);
-            if (config.symlink && isVideoType) {
-                // symlink
-                if (QFile::link(fn, absMediaFn)) {
-                    noCopy = false;
-                }
-            } else {
-                // copy
-                QFile fh(absMediaFn);
-                if (fh.open(QIODevice::WriteOnly)) {
-                    fh.write(data);
-                    fh.close();
-                    noCopy = false;
-                }
-            }
-        }
-    }
-    if (noCopy) {
-        if (isVideoType) {
-            game.videoFormat = "";
-        } else {
-            game.manualData = QByteArray();
-            game.manualFile = "";
-        }
-    }
-}
-
 int ScraperWorker::getReleaseYear(const QString releaseDateString) {
     // Most scrapers use "yyyy-MM-dd" format
     QDate releaseDate = QDate::fromString(releaseDateString, Qt::ISODate);
@@ -29,7 +29,7 @@
 #include "abstractscraper.h"
 #include "cache.h"
 #include "netmanager.h"
-#include "queue.h"
+#include "scrapepipeline.h"
 #include "settings.h"
 
 #include <QImage>
@@ -39,26 +39,22 @@ class ScraperWorker : public QObject {
     Q_OBJECT
 
 public:
-    ScraperWorker(QSharedPointer<Queue> queue, QSharedPointer<Cache> cache,
-                  QSharedPointer<NetManager> manager, Settings config,
+    ScraperWorker(QSharedPointer<ScrapePipeline> pipeline,
+                  QSharedPointer<Cache> cache, Settings config,
                   QString threadId);
     ~ScraperWorker();
     void run();
     bool forceEnd = false;
 
-signals:
-    void allDone();
-    void entryReady(const GameEntry &entry, const QString &output,
-                    const QString &debug);
-
 private:
     AbstractScraper *scraper;
 
     Settings config;
 
     QSharedPointer<Cache> cache;
+    // Created in run(), so it belongs to the thread of this worker
     QSharedPointer<NetManager> manager;
-    QSharedPointer<Queue> queue;
+    QSharedPointer<ScrapePipeline> pipeline;
 
     QString platformOrig;
     QString threadId;
@@ -77,8 +73,7 @@ private:
     int getReleaseYear(const QString releaseDateString);
 
     bool limitReached(QString &output);
-    void copyMedia(const QString &mediaType, const QString &completeBaseName,
-                   const QString &subPath, GameEntry &game);
+    void report(GameEntry &game, QString &output, QString &debug);
     bool matchTitles(const QString &thiz, const QString &that);
     QList<QString> splitTitle(const QString &title);
     bool matchWords(const QList<QString> theseWords,
@@ -35,18 +35,34 @@
 #include <QJsonDocument>
 #include <QProcess>
 
-constexpr int RETRIESMAX = 4;
 constexpr int MINARTSIZE = 256;
 
 ScreenScraper::ScreenScraper(Settings *config,
                              QSharedPointer<NetManager> manager)
     : AbstractScraper(config, manager, MatchType::MATCH_ONE) {
-    connect(&limitTimer, &QTimer::timeout, &limiter, &QEventLoop::quit);
-    limitTimer.setInterval(
-        1200); // 1.2 second request limit set a bit above 1.0 as requested by
-               // the good folks at ScreenScraper. Don't change!
-    limitTimer.setSingleShot(false);
-    limitTimer.start();
+    // 1.2 second request limit per thread set a bit above 1.0 as requested
+    // by the good folks at ScreenScraper. Don't change! The threads share the
+    // requests, so one busy thread doesn't leave its requests unused
+    const int threads = qMax(1, config->threads);
+    netComm->setRateLimiter(
+        RateLimiter::get("screenscraper", 1200 / threads, threads));
+    // Empty and busy answers are sent again, see RetryPolicy
+    netComm->setClassifier([](QNetworkReply::NetworkError error,
+                              int httpStatus, const QByteArray &data) {
+        if (error == QNetworkReply::NoError && httpStatus != 304 &&
+            data.isEmpty()) {
+            return RetryPolicy::RETRY;
+        }
+        if (isBusy(data.left(1024))) {
+            return RetryPolicy::OVERLOADED;
+        }
+        return RetryPolicy::classify(error, httpStatus, data);
+    });
+    // Game lookups echo the credentials and hold the request counts of the
+    // user, the media is fine to cache
+    netComm->setUncachedPaths(QStringList({"/api2/jeuInfos.php"}));
+    netComm->addSecret(StrTools::unMagic("204;198;236;130;203;181;203;126;"
+                                         "191;167;200;198;192;228;169;156"));
 
     baseUrl = "http://www.screenscraper.fr";
 
@@ -67,6 +83,21 @@ ScreenScraper::ScreenScraper(Settings *config,
     fetchOrder.append(MANUAL);
 }
 
+// ScreenScraper answers like this when it has no threads left for
+// unregistered or inactive users
+bool ScreenScraper::isBusy(const QByteArray &headerData) {
+    return headerData.contains("API fermé pour les non membres") ||
+           headerData.contains("API closed for non-registered members") ||
+           headerData.contains(
+               "****T****h****e**** ****m****a****x****i****m****u****m**** "
+               "****t****h****r****e****a****d****s**** "
+               "****a****l****l****o****w****e****d**** ****t****o**** "
+               "****l****e****e****c****h****e****r**** "
+               "****u****s****e****r****s**** ****i****s**** "
+               "****a****l****r****e****a****d****y**** "
+               "****u****s****e****d****");
+}
+
 void ScreenScraper::getSearchResults(QList<GameEntry> &gameEntries,
                                      QString searchName, QString) {
     int platformId = getPlatformId(config->platform);
@@ -88,153 +119,127 @@ void ScreenScraper::getSearchResults(QList<GameEntry> &gameEntries,
         (platformId == -1 ? "" : "&systemeid=" + QString::number(platformId)) +
         "&output=json&" + searchName;
 
-    for (int retries = 0; retries < RETRIESMAX; ++retries) {
-        limiter.exec();
-        netComm->request(gameUrl);
-        q.exec();
-        data = netComm->getData();
-
-        QByteArray headerData =
-            data.left(1024); // Minor optimization with minimal more RAM usage
-        // Do error checks on headerData. It's more stable than checking the
-        // potentially faulty JSON
-        if (headerData.isEmpty()) {
-            printf("\033[1;33mRetrying request...\033[0m\n\n");
-            continue;
-        } else if (headerData.contains("non trouvée")) {
-            return;
-        } else if (headerData.contains("API totalement fermé")) {
-            printf("\033[1;31mThe ScreenScraper API is currently closed, "
-                   "exiting nicely...\033[0m\n\n");
-            reqRemaining = 0;
-            return;
-        } else if (headerData.contains(
-                       "Le logiciel de scrape utilisé a été blacklisté")) {
-            printf("\033[1;31mSkyscraper has apparently been blacklisted at "
-                   "ScreenScraper, exiting nicely...\033[0m\n\n");
-            reqRemaining = 0;
-            return;
-        } else if (headerData.contains("Votre quota de scrape est")) {
-            printf("\033[1;31mYour daily ScreenScraper request limit has been "
-                   "reached, exiting nicely...\033[0m\n\n");
-            reqRemaining = 0;
-            return;
-        } else if (
-            headerData.contains("API fermé pour les non membres") ||
-            headerData.contains("API closed for non-registered members") ||
-            headerData.contains(
-                "****T****h****e**** ****m****a****x****i****m****u****m**** "
-                "****t****h****r****e****a****d****s**** "
-                "****a****l****l****o****w****e****d**** ****t****o**** "
-                "****l****e****e****c****h****e****r**** "
-                "****u****s****e****r****s**** ****i****s**** "
-                "****a****l****r****e****a****d****y**** "
-                "****u****s****e****d****")) {
-            printf(
-                "\033[1;31mThe screenscraper service is currently closed or "
-                "too busy to handle requests from unregistered and inactive "
-                "users. Sign up for an account at https://www.screenscraper.fr "
-                "and contribute to gain more threads. Then use the credentials "
-                "with Skyscraper using the '-u user:pass' command line option "
-                "or by setting 'userCreds=\"user:pass\"' in "
-                "'%s/config.ini'.\033[0m\n\n",
-                Config::getSkyFolder().toStdString().c_str());
-            if (retries == RETRIESMAX - 1) {
-                reqRemaining = 0;
-                return;
-            } else {
-                continue;
-            }
-        }
+    netComm->request(gameUrl);
+    q.exec();
+    data = netComm->getData();
 
-        // Fix faulty JSON that is sometimes received back from ScreenScraper
-        data.replace("],\n\t\t}", "]\n\t\t}");
-
-        // Now parse the JSON
-        jsonObj = QJsonDocument::fromJson(data).object();
-
-        // Check if we got a valid JSON document back
-        if (jsonObj.isEmpty()) {
-            printf("\033[1;31mScreenScraper APIv2 returned invalid / empty "
-                   "Json. Their servers are probably down. Please try again "
-                   "later or use a different scraping module with '-s MODULE'. "
-                   "Check 'Skyscraper --help' for more information.\033[0m\n");
-            data.replace(StrTools::unMagic("204;198;236;130;203;181;203;126;"
-                                           "191;167;200;198;192;228;169;156"),
-                         "****");
-            data.replace(config->password.toUtf8(), "****");
-            QFile jsonErrorFile(
-                Config::getSkyFolder(Config::SkyFolderType::LOG) +
-                "/screenscraper_error.json");
-            if (jsonErrorFile.open(QIODevice::WriteOnly)) {
-                if (data.length() > 64) {
-                    jsonErrorFile.write(data);
-                    printf("The erroneous answer was written to "
-                           "'%s/screenscraper_error.json'. "
-                           "If this file contains game data, please consider "
-                           "filing a bug report at "
-                           "'https://github.com/Gemba/skyscraper/issues' and "
-                           "attach that file.\n",
-                           QFileInfo(jsonErrorFile)
-                               .absoluteFilePath()
-                               .toStdString()
-                               .c_str());
-                }
-                jsonErrorFile.close();
-            }
-            break; // DON'T try again! If we don't get a valid JSON document,
-                   // something is very wrong with the API
-        }
-
-        // Check if the request was successful
-        if (jsonObj["header"].toObject()["success"].toString() != "true") {
-            printf("Request returned a success state of '%s'. Error was:\n%s\n",
-                   jsonObj["header"]
-                       .toObject()["success"]
-                       .toString()
-                       .toStdString()
-                       .c_str(),
-                   jsonObj["header"]
-                       .toObject()["error"]
-                       .toString()
-                       .toStdString()
-                       .c_str());
-            // Try again. We handle important errors above, so something weird
-            // is going on here
-            continue;
-        }
+    QByteArray headerData =
+        data.left(1024); // Minor optimization with minimal more RAM usage
+    // Do error checks on headerData. It's more stable than checking the
+    // potentially faulty JSON. Empty and busy answers have already been
+    // retried by the time they get here
+    if (headerData.isEmpty()) {
+        return;
+    } else if (headerData.contains("non trouvée")) {
+        return;
+    } else if (headerData.contains("API totalement fermé")) {
+        printf("\033[1;31mThe ScreenScraper API is currently closed, "
+               "exiting nicely...\033[0m\n\n");
+        reqRemaining = 0;
+        return;
+    } else if (headerData.contains(
+                   "Le logiciel de scrape utilisé a été blacklisté")) {
+        printf("\033[1;31mSkyscraper has apparently been blacklisted at "
+               "ScreenScraper, exiting nicely...\033[0m\n\n");
+        reqRemaining = 0;
+        return;
+    } else if (headerData.contains("Votre quota de scrape est")) {
+        printf("\033[1;31mYour daily ScreenScraper request limit has been "
+               "reached, exiting nicely...\033[0m\n\n");
+        reqRemaining = 0;
+        return;
+    } else if (isBusy(headerData)) {
+        printf(
+            "\033[1;31mThe screenscraper service is currently closed or "
+            "too busy to handle requests from unregistered and inactive "
+            "users. Sign up for an account at https://www.screenscraper.fr "
+            "and contribute to gain more threads. Then use the credentials "
+            "with Skyscraper using the '-u user:pass' command line option "
+            "or by setting 'userCreds=\"user:pass\"' in "
+            "'%s/config.ini'.\033[0m\n\n",
+            Config::getSkyFolder().toStdString().c_str());
+        reqRemaining = 0;
+        return;
+    }
 
-        // Check if user has exceeded daily request limit
-        if (!jsonObj["response"]
-                 .toObject()["ssuser"]
-                 .toObject()["requeststoday"]
-                 .toString()
-                 .isEmpty() &&
-            !jsonObj["response"]
-                 .toObject()["ssuser"]
-                 .toObject()["maxrequestsperday"]
-                 .toString()
-                 .isEmpty()) {
-            reqRemaining = jsonObj["response"]
-                               .toObject()["ssuser"]
-                               .toObject()["maxrequestsperday"]
-                               .toString()
-                               .toInt() -
-                           jsonObj["response"]
-                               .toObject()["ssuser"]
-                               .toObject()["requeststoday"]
-                               .toString()
-                               .toInt();
-            if (reqRemaining <= 0) {
-                printf("\033[1;31mYour daily ScreenScraper request limit has "
-                       "been reached, exiting nicely...\033[0m\n\n");
+    // Fix faulty JSON that is sometimes received back from ScreenScraper
+    data.replace("],\n\t\t}", "]\n\t\t}");
+
+    // Now parse the JSON
+    jsonObj = QJsonDocument::fromJson(data).object();
+
+    // Check if we got a valid JSON document back
+    if (jsonObj.isEmpty()) {
+        printf("\033[1;31mScreenScraper APIv2 returned invalid / empty "
+               "Json. Their servers are probably down. Please try again "
+               "later or use a different scraping module with '-s MODULE'. "
+               "Check 'Skyscraper --help' for more information.\033[0m\n");
+        data.replace(StrTools::unMagic("204;198;236;130;203;181;203;126;"
+                                       "191;167;200;198;192;228;169;156"),
+                     "****");
+        data.replace(config->password.toUtf8(), "****");
+        QFile jsonErrorFile(
+            Config::getSkyFolder(Config::SkyFolderType::LOG) +
+            "/screenscraper_error.json");
+        if (jsonErrorFile.open(QIODevice::WriteOnly)) {
+            if (data.length() > 64) {
+                jsonErrorFile.write(data);
+                printf("The erroneous answer was written to "
+                       "'%s/screenscraper_error.json'. "
+                       "If this file contains game data, please consider "
+                       "filing a bug report at "
+                       "'https://github.com/Gemba/skyscraper/issues' and "
+                       "attach that file.\n",
+                       QFileInfo(jsonErrorFile)
+                           .absoluteFilePath()
+                           .toStdString()
+                           .c_str());
             }
+            jsonErrorFile.close();
         }
+        return;
+    }
 
-        // Check if we got a game entry back
-        if (jsonObj["response"].toObject().contains("jeu")) {
-            // Game found, stop retrying
-            break;
+    // Check if the request was successful
+    if (jsonObj["header"].toObject()["success"].toString() != "true") {
+        printf("Request returned a success state of '%s'. Error was:\n%s\n",
+               jsonObj["header"]
+                   .toObject()["success"]
+                   .toString()
+                   .toStdString()
+                   .c_str(),
+               jsonObj["header"]
+                   .toObject()["error"]
+                   .toString()
+                   .toStdString()
+                   .c_str());
+        return;
+    }
+
+    // Check if user has exceeded daily request limit
+    if (!jsonObj["response"]
+             .toObject()["ssuser"]
+             .toObject()["requeststoday"]
+             .toString()
+             .isEmpty() &&
+        !jsonObj["response"]
+             .toObject()["ssuser"]
+             .toObject()["maxrequestsperday"]
+             .toString()
+             .isEmpty()) {
+        reqRemaining = jsonObj["response"]
+                           .toObject()["ssuser"]
+                           .toObject()["maxrequestsperday"]
+                           .toString()
+                           .toInt() -
+                       jsonObj["response"]
+                           .toObject()["ssuser"]
+                           .toObject()["requeststoday"]
+                           .toString()
+                           .toInt();
+        if (reqRemaining <= 0) {
+            printf("\033[1;31mYour daily ScreenScraper request limit has "
+                   "been reached, exiting nicely...\033[0m\n\n");
         }
     }
 
@@ -345,17 +350,13 @@ void ScreenScraper::getTags(GameEntry &game) {
 
 QByteArray ScreenScraper::downloadMedia(const QString &url) {
     if (!url.isEmpty()) {
-        for (int retries = 0; retries < RETRIESMAX; ++retries) {
-            limiter.exec();
-            netComm->request(url);
-            q.exec();
-            QImage image;
-            if (netComm->getError(config->verbosity) ==
-                    QNetworkReply::NoError &&
-                netComm->getData().size() >= MINARTSIZE &&
-                image.loadFromData(netComm->getData())) {
-                return netComm->getData();
-            }
+        netComm->request(url);
+        q.exec();
+        QImage image;
+        if (netComm->getError(config->verbosity) == QNetworkReply::NoError &&
+            netComm->getData().size() >= MINARTSIZE &&
+            image.loadFromData(netComm->getData())) {
+            return netComm->getData();
         }
     }
     return QByteArray();
@@ -364,38 +365,19 @@ QByteArray ScreenScraper::downloadMedia(const QString &url) {
 void ScreenScraper::downloadBinary(const QString &url, const QString &type,
                                    GameEntry &game) {
     bool isVideoType = type == "video";
-    for (int retries = 0; retries < RETRIESMAX; ++retries) {
-        limiter.exec();
-        netComm->request(url);
-        q.exec();
-        if (isVideoType) {
-            game.videoData = netComm->getData();
-        } else {
-            game.manualData = netComm->getData();
-        }
-        QByteArray contentType = netComm->getContentType();
-        if (netComm->getError(config->verbosity) == QNetworkReply::NoError) {
-            // Make sure received data is actually a video file/pdf file
-            if (isVideoType) {
-                if (contentType.contains("video/") &&
-                    game.videoData.size() > 4096) {
-                    game.videoFormat = contentType.mid(
-                        contentType.indexOf("/") + 1,
-                        contentType.length() - contentType.indexOf("/") + 1);
-                    break;
-                }
-            } else {
-                if (contentType.contains("application/pdf")) {
-                    break;
-                }
-            }
-        } else {
-            if (isVideoType) {
-                game.videoData = QByteArray();
-            } else {
-                game.manualData = QByteArray();
-            }
+    // Make sure received data is actually a video file/pdf file
+    const QByteArray expected = isVideoType ? "video/" : "application/pdf";
+    NetComm::Download download;
+    if (downloadToCache(url, type, expected, game, download)) {
+        if (isVideoType && download.size > 4096) {
+            const QByteArray &contentType = download.contentType;
+            game.videoFormat = contentType.mid(
+                contentType.indexOf("/") + 1,
+                contentType.length() - contentType.indexOf("/") + 1);
         }
+    } else if (netComm->getError() != QNetworkReply::OperationCanceledError) {
+        // Not cancelled for being of the wrong type or too big
+        netComm->getError(config->verbosity);
     }
 }
 
@@ -28,9 +28,7 @@
 
 #include "abstractscraper.h"
 
-#include <QEventLoop>
 #include <QJsonObject>
-#include <QTimer>
 
 constexpr int REGION = 0;
 constexpr int LANGUE = 1;
@@ -43,8 +41,6 @@ public:
     ScreenScraper(Settings *config, QSharedPointer<NetManager> manager);
 
 private:
-    QTimer limitTimer;
-    QEventLoop limiter;
     QList<QString> getSearchNames(const QFileInfo &info,
                                   QString &debug) override;
     void getSearchResults(QList<GameEntry> &gameEntries, QString searchName,
@@ -69,6 +65,7 @@ private:
 
     QString getJsonText(QJsonArray array, int attr,
                         QList<QString> types = QList<QString>());
+    static bool isBusy(const QByteArray &headerData);
     QByteArray downloadMedia(const QString &url);
     void downloadBinary(const QString &url, const QString &type,
                         GameEntry &game);
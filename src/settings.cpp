@@ -271,6 +271,22 @@ void RuntimeCfg::applyConfigIni(CfgType type, QSettings *settings,
                 config->platform = v;
                 continue;
             }
+            if (k == "queueOrder") {
+                config->queueOrder = v;
+                continue;
+            }
+            if (k == "recordTo" || k == "replayFrom") {
+                const QString folder =
+                    (!v.isEmpty() && QFileInfo(v).isRelative())
+                        ? concatPath(Config::getSkyFolder(), v)
+                        : v;
+                if (k == "recordTo") {
+                    config->recordTo = folder;
+                } else {
+                    config->replayFrom = folder;
+                }
+                continue;
+            }
             if (k == "region") {
                 config->region = v;
                 continue;
@@ -305,10 +321,18 @@ void RuntimeCfg::applyConfigIni(CfgType type, QSettings *settings,
                 config->brackets = v;
                 continue;
             }
+            if (k == "cacheBinary") {
+                config->cacheBinary = v;
+                continue;
+            }
             if (k == "cacheCovers") {
                 config->cacheCovers = v;
                 continue;
             }
+            if (k == "cacheDedupe") {
+                config->cacheDedupe = v;
+                continue;
+            }
             if (k == "cacheMarquees") {
                 config->cacheMarquees = v;
                 continue;
@@ -361,6 +385,10 @@ void RuntimeCfg::applyConfigIni(CfgType type, QSettings *settings,
                 config->hints = v;
                 continue;
             }
+            if (k == "httpCache") {
+                config->httpCache = v;
+                continue;
+            }
             if (k == "interactive") {
                 config->interactive = v;
                 continue;
@@ -385,6 +413,10 @@ void RuntimeCfg::applyConfigIni(CfgType type, QSettings *settings,
                 config->pretend = v;
                 continue;
             }
+            if (k == "quiet") {
+                config->quiet = v;
+                continue;
+            }
             if (k == "relativePaths") {
                 config->relativePaths = v;
                 continue;
@@ -444,6 +476,11 @@ void RuntimeCfg::applyConfigIni(CfgType type, QSettings *settings,
                 continue;
             }
         } else if (conv == "int") {
+            if (k == "threads" && ss.toString() == "auto") {
+                config->threadsAuto = true;
+                config->threadsSet = false;
+                continue;
+            }
             bool intOk;
             int v = ss.toInt(&intOk);
             if (!intOk) {
@@ -453,6 +490,56 @@ void RuntimeCfg::applyConfigIni(CfgType type, QSettings *settings,
                        k.toUtf8().constData());
                 exit(1);
             }
+            if (k == "connectionsPerHost") {
+                if (0 < v && v <= 16) {
+                    config->connectionsPerHost = v;
+                } else {
+                    printf("\033[1;33mValue of %d is out of range and is "
+                           "ignored! Consult the documentation.\n\033[0m",
+                           v);
+                }
+                continue;
+            }
+            if (k == "connectTimeout") {
+                if (0 <= v) {
+                    config->connectTimeout = v;
+                } else {
+                    printf("\033[1;33mValue of %d is out of range and is "
+                           "ignored! Consult the documentation.\n\033[0m",
+                           v);
+                }
+                continue;
+            }
+            if (k == "firstByteTimeout") {
+                if (0 <= v) {
+                    config->firstByteTimeout = v;
+                } else {
+                    printf("\033[1;33mValue of %d is out of range and is "
+                           "ignored! Consult the documentation.\n\033[0m",
+                           v);
+                }
+                continue;
+            }
+            if (k == "httpCacheSize") {
+                if (0 <= v) {
+                    config->httpCacheSize = v;
+                } else {
+                    printf("\033[1;33mValue of %d is out of range and is "
+                           "ignored! Consult the documentation.\n\033[0m",
+                           v);
+                }
+                continue;
+            }
+            if (k == "httpCacheTtl") {
+                if (0 <= v) {
+                    config->httpCacheTtl = v;
+                } else {
+                    printf("\033[1;33mValue of %d is out of range and is "
+                           "ignored! Consult the documentation.\n\033[0m",
+                           v);
+                }
+                continue;
+            }
             if (k == "jpgQuality") {
                 if (0 < v && v <= 100) {
                     config->jpgQuality = v;
@@ -498,6 +585,27 @@ void RuntimeCfg::applyConfigIni(CfgType type, QSettings *settings,
             if (k == "threads") {
                 config->threads = v;
                 config->threadsSet = true;
+                config->threadsAuto = false;
+                continue;
+            }
+            if (k == "replayLatency") {
+                if (0 <= v) {
+                    config->replayLatency = v;
+                } else {
+                    printf("\033[1;33mValue of %d is out of range and is "
+                           "ignored! Consult the documentation.\n\033[0m",
+                           v);
+                }
+                continue;
+            }
+            if (k == "totalTimeout") {
+                if (0 <= v) {
+                    config->totalTimeout = v;
+                } else {
+                    printf("\033[1;33mValue of %d is out of range and is "
+                           "ignored! Consult the documentation.\n\033[0m",
+                           v);
+                }
                 continue;
             }
             if (k == "verbosity") {
@@ -524,9 +632,13 @@ void RuntimeCfg::applyCli(bool &inputFolderSet, bool &gameListFolderSet,
         parser->value("l").toInt() <= 10000) {
         config->maxLength = parser->value("l").toInt();
     }
-    if (parser->isSet("t") && parser->value("t").toInt() <= 8) {
+    if (parser->isSet("t") && parser->value("t") == "auto") {
+        config->threadsAuto = true;
+        config->threadsSet = false;
+    } else if (parser->isSet("t") && parser->value("t").toInt() <= 8) {
         config->threads = parser->value("t").toInt();
         config->threadsSet = true;
+        config->threadsAuto = false;
     }
     if (parser->isSet("e")) {
         config->frontendExtra = parser->value("e");
@@ -638,6 +750,8 @@ void RuntimeCfg::applyCli(bool &inputFolderSet, bool &gameListFolderSet,
 void RuntimeCfg::setFlag(const QString flag) {
     if (flag == "forcefilename") {
         config->forceFilename = true;
+    } else if (flag == "hardlink") {
+        config->hardlink = true;
     } else if (flag == "interactive") {
         config->interactive = true;
     } else if (flag == "nobrackets") {
@@ -664,6 +778,8 @@ void RuntimeCfg::setFlag(const QString flag) {
         config->onlyMissing = true;
     } else if (flag == "pretend") {
         config->pretend = true;
+    } else if (flag == "quiet") {
+        config->quiet = true;
     } else if (flag == "relative") {
         config->relativePaths = true;
     } else if (flag == "skipexistingcovers") {
@@ -73,6 +73,9 @@ struct Settings {
     int doneThreads = 0;
     int threads = 4;
     bool threadsSet = false;
+    // threads="auto", 'threads' is then the most the pipeline may use
+    bool threadsAuto = false;
+    QString queueOrder = "";
     int minMatch = 65;
     bool minMatchSet = false;
     int notFound = 0;
@@ -84,6 +87,19 @@ struct Settings {
     bool refresh = false;
     QString cacheOptions = "";
     bool cacheResize = true;
+    bool cacheBinary = false;
+    bool cacheDedupe = false;
+    bool httpCache = false;
+    int connectionsPerHost = 6;
+    int httpCacheTtl = 24; // Hours
+    int httpCacheSize = 2000; // MB, 0 is no limit
+    // Seconds, 0 is no limit
+    int connectTimeout = 10;
+    int firstByteTimeout = 30;
+    int totalTimeout = 120;
+    QString recordTo = "";
+    QString replayFrom = "";
+    int replayLatency = 100; // Percent of the recorded time
     int jpgQuality = 95;
     bool subdirs = true;
     bool onlyMissing = false;
@@ -97,6 +113,7 @@ struct Settings {
     bool stats = false;
     bool hints = true;
     int verbosity = 0;
+    bool quiet = false;
     int maxFails = 42;
     bool skipped = false;
     bool tidyDesc = true;
@@ -126,6 +143,7 @@ struct Settings {
     QString videoConvertCommand = "";
     QString videoConvertExtension = "";
     bool symlink = false;
+    bool hardlink = false;
     bool skipExistingVideos = false;
     bool cacheCovers = true;
     bool skipExistingCovers = false;
@@ -191,7 +209,9 @@ private:
         {"addFolders",            QPair<QString, int>("bool",                                     CfgType::FRONTEND                    )},
         {"artworkXml",            QPair<QString, int>("str",  CfgType::MAIN | CfgType::PLATFORM | CfgType::FRONTEND                    )},
         {"brackets",              QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM | CfgType::FRONTEND                    )},
+        {"cacheBinary",           QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM                                        )},
         {"cacheCovers",           QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM |                     CfgType::SCRAPER )},
+        {"cacheDedupe",           QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM                                        )},
         {"cacheFolder",           QPair<QString, int>("str",  CfgType::MAIN | CfgType::PLATFORM                                        )},
         {"cacheMarquees",         QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM |                     CfgType::SCRAPER )},
         {"cacheRefresh",          QPair<QString, int>("bool", CfgType::MAIN |                                         CfgType::SCRAPER )},
@@ -199,18 +219,24 @@ private:
         {"cacheScreenshots",      QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM |                     CfgType::SCRAPER )},
         {"cacheTextures",         QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM |                     CfgType::SCRAPER )},
         {"cacheWheels",           QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM |                     CfgType::SCRAPER )},
+        {"connectionsPerHost",    QPair<QString, int>("int",  CfgType::MAIN | CfgType::PLATFORM |                     CfgType::SCRAPER )},
+        {"connectTimeout",        QPair<QString, int>("int",  CfgType::MAIN | CfgType::PLATFORM |                     CfgType::SCRAPER )},
         {"cropBlack",             QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM | CfgType::FRONTEND                    )},
         {"emulator",              QPair<QString, int>("str",  CfgType::MAIN | CfgType::PLATFORM | CfgType::FRONTEND                    )},
         {"endAt",                 QPair<QString, int>("str",                  CfgType::PLATFORM | CfgType::FRONTEND                    )},
         {"excludeFrom",           QPair<QString, int>("str",  CfgType::MAIN | CfgType::PLATFORM                                        )},
         {"excludePattern",        QPair<QString, int>("str",  CfgType::MAIN | CfgType::PLATFORM | CfgType::FRONTEND                    )},
         {"extensions",            QPair<QString, int>("str",                  CfgType::PLATFORM                                        )},
+        {"firstByteTimeout",      QPair<QString, int>("int",  CfgType::MAIN | CfgType::PLATFORM |                     CfgType::SCRAPER )},
         {"forceFilename",         QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM | CfgType::FRONTEND                    )},
         {"frontend",              QPair<QString, int>("str",  CfgType::MAIN                                                            )},
         {"gameListBackup",        QPair<QString, int>("bool", CfgType::MAIN |                     CfgType::FRONTEND                    )},
         {"gameListFolder",        QPair<QString, int>("str",  CfgType::MAIN | CfgType::PLATFORM | CfgType::FRONTEND                    )},
         {"gameListVariants",      QPair<QString, int>("str",                                      CfgType::FRONTEND                    )},
         {"hints",                 QPair<QString, int>("bool", CfgType::MAIN                                                            )},
+        {"httpCache",             QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM |                     CfgType::SCRAPER )},
+        {"httpCacheSize",         QPair<QString, int>("int",  CfgType::MAIN | CfgType::PLATFORM |                     CfgType::SCRAPER )},
+        {"httpCacheTtl",          QPair<QString, int>("int",  CfgType::MAIN | CfgType::PLATFORM |                     CfgType::SCRAPER )},
         {"importFolder",          QPair<QString, int>("str",  CfgType::MAIN | CfgType::PLATFORM                                        )},
         {"includeFrom",           QPair<QString, int>("str",  CfgType::MAIN | CfgType::PLATFORM                                        )},
         {"includePattern",        QPair<QString, int>("str",  CfgType::MAIN | CfgType::PLATFORM | CfgType::FRONTEND                    )},
@@ -230,9 +256,14 @@ private:
         {"onlyMissing",           QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM |                     CfgType::SCRAPER )},
         {"platform",              QPair<QString, int>("str",  CfgType::MAIN                                                            )},
         {"pretend",               QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM                                        )},
+        {"queueOrder",            QPair<QString, int>("str",  CfgType::MAIN | CfgType::PLATFORM                                        )},
+        {"quiet",                 QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM                                        )},
+        {"recordTo",              QPair<QString, int>("str",  CfgType::MAIN                                                            )},
         {"region",                QPair<QString, int>("str",  CfgType::MAIN | CfgType::PLATFORM                                        )},
         {"regionPrios",           QPair<QString, int>("str",  CfgType::MAIN | CfgType::PLATFORM                                        )},
         {"relativePaths",         QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM                                        )},
+        {"replayFrom",            QPair<QString, int>("str",  CfgType::MAIN                                                            )},
+        {"replayLatency",         QPair<QString, int>("int",  CfgType::MAIN                                                            )},
         {"scummIni",              QPair<QString, int>("str",  CfgType::MAIN                                                            )},
         {"skipped",               QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM | CfgType::FRONTEND                    )},
         {"spaceCheck",            QPair<QString, int>("bool", CfgType::MAIN                                                            )},
@@ -242,6 +273,7 @@ private:
         {"theInFront",            QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM | CfgType::FRONTEND                    )},
         {"threads",               QPair<QString, int>("int",  CfgType::MAIN | CfgType::PLATFORM |                     CfgType::SCRAPER )},
         {"tidyDesc",              QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM |                     CfgType::SCRAPER )},
+        {"totalTimeout",          QPair<QString, int>("int",  CfgType::MAIN | CfgType::PLATFORM |                     CfgType::SCRAPER )},
         {"unattend",              QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM | CfgType::FRONTEND | CfgType::SCRAPER )},
         {"unattendSkip",          QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM | CfgType::FRONTEND | CfgType::SCRAPER )},
         {"unpack",                QPair<QString, int>("bool", CfgType::MAIN | CfgType::PLATFORM                                        )},
@@ -50,6 +50,7 @@
 #include "attractmode.h"
 #include "emulationstation.h"
 #include "esde.h"
+#include "httpcache.h"
 #include "pegasus.h"
 #include "settings.h"
 #include "skyscraper.h"
@@ -58,6 +59,8 @@
 Skyscraper::Skyscraper(const QCommandLineParser &parser,
                        const QString &currentDir) {
     qRegisterMetaType<GameEntry>("GameEntry");
+    qRegisterMetaType<QSharedPointer<ScrapeResult>>(
+        "QSharedPointer<ScrapeResult>");
 
     manager = QSharedPointer<NetManager>(new NetManager());
 
@@ -126,7 +129,6 @@ void Skyscraper::run() {
 
     prepareScraping();
 
-    doneThreads = 0;
     notFound = 0;
     found = 0;
     avgCompleteness = 0;
@@ -147,7 +149,8 @@ void Skyscraper::run() {
     }
 
     if (!config.cacheFolder.isEmpty()) {
-        cache = QSharedPointer<Cache>(new Cache(config.cacheFolder));
+        cache = QSharedPointer<Cache>(
+            new Cache(config.cacheFolder, config.cacheBinary));
         if (cacheScrapeMode || cache->createFolders(config.scraper)) {
             if (!cache->read() && cacheScrapeMode) {
                 printf("No resources for this platform found in the resource "
@@ -161,6 +164,11 @@ void Skyscraper::run() {
                    "permissions and try again...\n");
             exit(1);
         }
+        if (!cacheScrapeMode && config.httpCache && config.httpCacheSize > 0) {
+            HttpCache httpCache(config.cacheFolder + "/http",
+                                config.httpCacheTtl * 60 * 60);
+            httpCache.prune((qint64)config.httpCacheSize * 1000 * 1000);
+        }
     }
 
     if (config.verbosity || config.cacheOptions == "show") {
@@ -212,7 +220,8 @@ void Skyscraper::run() {
         if (mergeCacheInfo.isDir()) {
             Cache mergeCache(absMergeCacheFilePath);
             mergeCache.read();
-            cache->merge(mergeCache, config.refresh, absMergeCacheFilePath);
+            cache->merge(mergeCache, config.refresh, absMergeCacheFilePath,
+                         config.hardlink);
             state = NO_INTR; // Ignore ctrl+c
             cache->write();
             state = SINGLE;
@@ -330,6 +339,7 @@ void Skyscraper::run() {
         }
     }
 
+    queue->sortEntries(config.queueOrder);
     totalFiles = queue->length();
 
     if (config.romLimit != -1 && totalFiles > config.romLimit) {
@@ -364,9 +374,10 @@ void Skyscraper::run() {
         if (totalFiles > 0) {
             printf(
                 "Starting scraping run on \033[1;32m%d\033[0m files using "
-                "\033[1;32m%d\033[0m threads.\nSit back, relax and let me do "
-                "the work! :)\n\n",
-                totalFiles, config.threads);
+                "%s\033[1;32m%d\033[0m threads.\nSit back, relax and let me "
+                "do the work! :)\n\n",
+                totalFiles, config.threadsAuto ? "up to " : "",
+                config.threads);
         } else {
             printf("\nNo entries to scrape...\n\n");
         }
@@ -379,27 +390,39 @@ void Skyscraper::run() {
     timer.start();
     currentFile = 1;
 
+    // Do not start more threads if we have less files than allowed threads
+    if (totalFiles > 0 && totalFiles < config.threads) {
+        config.threads = totalFiles;
+    }
+    reportWriter =
+        QSharedPointer<ReportWriter>(new ReportWriter(skippedFileString));
+    if (config.spaceCheck) {
+        connect(&spaceTimer, &QTimer::timeout, this,
+                &Skyscraper::checkDiskSpace);
+        spaceTimer.start(5000);
+    }
+    pipeline = QSharedPointer<ScrapePipeline>(
+        new ScrapePipeline(queue, cache, config));
+    connect(pipeline.data(), &ScrapePipeline::entryReady, this,
+            &Skyscraper::entryReady);
+    connect(pipeline.data(), &ScrapePipeline::allDone, this,
+            &Skyscraper::checkThreads);
+    connect(pipeline.data(), &ScrapePipeline::threadsTuned, this,
+            &Skyscraper::threadsTuned);
+
     QList<QThread *> threadList;
     for (int curThread = 1; curThread <= config.threads; ++curThread) {
         QThread *thread = new QThread;
-        ScraperWorker *worker = new ScraperWorker(queue, cache, manager, config,
+        ScraperWorker *worker = new ScraperWorker(pipeline, cache, config,
                                                   QString::number(curThread));
         worker->moveToThread(thread);
         connect(thread, &QThread::started, worker, &ScraperWorker::run);
-        connect(worker, &ScraperWorker::entryReady, this,
-                &Skyscraper::entryReady);
-        connect(worker, &ScraperWorker::allDone, this,
-                &Skyscraper::checkThreads);
         connect(thread, &QThread::finished, worker,
                 &ScraperWorker::deleteLater);
         threadList.append(thread);
-        // Do not start more threads if we have less files than allowed threads
-        if (curThread == totalFiles) {
-            config.threads = curThread;
-            break;
-        }
     }
-    // Ready, set, GO! Start all threads
+    // Ready, set, GO! Start all stages
+    pipeline->start(threadList.size());
     for (const auto thread : threadList) {
         thread->start();
         state = THREADED;
@@ -578,49 +601,66 @@ QString Skyscraper::secsToString(const int &secs) {
     return hours + ":" + minutes + ":" + seconds;
 }
 
-void Skyscraper::entryReady(const GameEntry &entry, const QString &output,
-                            const QString &debug) {
+void Skyscraper::entryReady(QSharedPointer<ScrapeResult> result) {
     QMutexLocker locker(&entryMutex);
 
-    printf("\033[0;32m#%d/%d\033[0m %s\n", currentFile, totalFiles,
-           output.toStdString().c_str());
-
-    if (config.verbosity >= 3) {
-        printf("\033[1;33mDebug output:\033[0m\n%s\n",
-               debug.toStdString().c_str());
-    }
-
+    GameEntry &entry = result->game;
+    const QString &output = result->output;
+    const QString &debug = result->debug;
+    bool keep = true;
     if (entry.found) {
         found++;
         avgCompleteness += entry.getCompleteness();
         avgSearchMatch += entry.searchMatch;
-        gameEntries.append(entry);
     } else {
         notFound++;
-        QFile skippedFile(skippedFileString);
-        skippedFile.open(QIODevice::Append);
-        skippedFile.write(entry.absoluteFilePath.toUtf8() + "\n");
-        skippedFile.close();
-        if (config.skipped) {
-            gameEntries.append(entry);
-        }
+        reportWriter->addSkipped(entry.absoluteFilePath);
+        keep = config.skipped;
+    }
+    if (keep) {
+        // Moved rather than copied, QList has no append() taking an rvalue in
+        // Qt 5
+        gameEntries.append(GameEntry());
+        gameEntries.last() = std::move(entry);
     }
 
-    printf(
-        "\033[1;34m#%d/%d\033[0m, (\033[1;32m%d\033[0m/\033[1;33m%d\033[0m)\n",
-        currentFile, totalFiles, found, notFound);
     int elapsed = timer.elapsed();
     int estTime = (elapsed / currentFile * totalFiles) - elapsed;
     if (estTime < 0)
         estTime = 0;
-    printf("Elapsed time   : \033[1;33m%s\033[0m\n",
-           secsToString(elapsed).toStdString().c_str());
-    printf("Est. time left : \033[1;33m%s\033[0m\n\n",
-           secsToString(estTime).toStdString().c_str());
+    const QString progress =
+        "\033[1;34m#" + QString::number(currentFile) + "/" +
+        QString::number(totalFiles) + "\033[0m, (\033[1;32m" +
+        QString::number(found) + "\033[0m/\033[1;33m" +
+        QString::number(notFound) + "\033[0m)";
+    if (config.quiet) {
+        // A single line now and then instead of the full report
+        if (elapsed - lastProgress >= 1000 || currentFile == totalFiles) {
+            lastProgress = elapsed;
+            reportWriter->print(
+                QString(progress + ", est. time left: \033[1;33m" +
+                        secsToString(estTime) + "\033[0m\n")
+                    .toUtf8());
+        }
+    } else {
+        QString report = "\033[0;32m#" + QString::number(currentFile) + "/" +
+                         QString::number(totalFiles) + "\033[0m " + output +
+                         "\n";
+        if (config.verbosity >= 3) {
+            report.append("\033[1;33mDebug output:\033[0m\n" + debug + "\n");
+        }
+        report.append(progress + "\n");
+        report.append("Elapsed time   : \033[1;33m" + secsToString(elapsed) +
+                      "\033[0m\n");
+        report.append("Est. time left : \033[1;33m" + secsToString(estTime) +
+                      "\033[0m\n\n");
+        reportWriter->print(report.toUtf8());
+    }
 
     if (!config.onlyMissing && currentFile == config.maxFails &&
         notFound == config.maxFails && config.scraper != "import" &&
         config.scraper != "cache") {
+        reportWriter->finish();
         printf("\033[1;31mThis is NOT going well! I guit! *slams the "
                "door*\nNo, seriously, out of %d files we had %d misses. So "
                "either the scraping source is down or you are using a scraping "
@@ -630,46 +670,55 @@ void Skyscraper::entryReady(const GameEntry &entry, const QString &output,
         exit(1);
     }
     currentFile++;
+}
+
+void Skyscraper::threadsTuned(int active, int max) {
+    reportWriter->print(QString("\033[1;34mNow scraping with %1 of %2 "
+                                "threads.\033[0m\n")
+                            .arg(active)
+                            .arg(max)
+                            .toUtf8());
+}
 
+// Runs on a timer rather than for every entry, the free space of a drive
+// doesn't change much between two games
+void Skyscraper::checkDiskSpace() {
 #if QT_VERSION >= 0x050400
     qint64 spaceLimit = 209715200;
-    if (config.spaceCheck) {
-        if (config.scraper == "cache" && !config.pretend &&
-            QStorageInfo(QDir(config.screenshotsFolder)).bytesFree() <
-                spaceLimit) {
-            printf("\033[1;31mYou have very little disk space left on the "
-                   "Skyscraper media export drive, please free up some space "
-                   "and try again. Now aborting...\033[0m\n\n");
-            printf("Note! You can disable this check by setting "
-                   "'spaceCheck=\"false\"' in the '[main]' section of "
-                   "config.ini.\n\n");
-            // By clearing the queue here we basically tell Skyscraper to stop
-            // and quit nicely
-            config.pretend = true;
-            queue->clearAll();
-        } else if (QStorageInfo(QDir(config.cacheFolder)).bytesFree() <
-                   spaceLimit) {
-            printf("\033[1;31mYou have very little disk space left on the "
-                   "Skyscraper resource cache drive, please free up some space "
-                   "and try again. Now aborting...\033[0m\n\n");
-            printf("Note! You can disable this check by setting "
-                   "'spaceCheck=\"false\"' in the '[main]' section of "
-                   "config.ini.\n\n");
-            // By clearing the queue here we basically tell Skyscraper to stop
-            // and quit nicely
-            config.pretend = true;
-            queue->clearAll();
-        }
+    QString drive;
+    if (config.scraper == "cache" && !config.pretend &&
+        QStorageInfo(QDir(config.screenshotsFolder)).bytesFree() <
+            spaceLimit) {
+        drive = "media export";
+    } else if (QStorageInfo(QDir(config.cacheFolder)).bytesFree() <
+               spaceLimit) {
+        drive = "resource cache";
+    }
+    if (drive.isEmpty()) {
+        return;
     }
+    spaceTimer.stop();
+    reportWriter->print(
+        QString("\033[1;31mYou have very little disk space left on the "
+                "Skyscraper " +
+                drive +
+                " drive, please free up some space and try again. Now "
+                "aborting...\033[0m\n\nNote! You can disable this check by "
+                "setting 'spaceCheck=\"false\"' in the '[main]' section of "
+                "config.ini.\n\n")
+            .toUtf8());
+    // By clearing the queue here we basically tell Skyscraper to stop and
+    // quit nicely
+    config.pretend = true;
+    queue->clearAll();
 #endif
 }
 
 void Skyscraper::checkThreads() {
     QMutexLocker locker(&checkThreadMutex);
 
-    doneThreads++;
-    if (doneThreads != config.threads)
-        return;
+    spaceTimer.stop();
+    reportWriter->finish();
 
     if (!config.pretend && config.scraper == "cache") {
         printf("\033[1;34m---- Game list generation run completed! YAY! "
@@ -680,23 +729,26 @@ void Skyscraper::checkThreads() {
             state = SINGLE;
         }
         frontend->sortEntries(gameEntries);
-        printf("Assembling game list...");
-        QString finalOutput;
-        frontend->assembleList(finalOutput, gameEntries);
-        printf(" \033[1;32mDone!\033[0m\n");
-        QFile gameListFile(gameListFileString);
-        printf("Now writing '\033[1;33m%s\033[0m'... ",
+        // The game list is written while it is assembled. It only replaces
+        // the existing one once it has been written in full
+        GameListWriter gameList(gameListFileString);
+        printf("Assembling and writing '\033[1;33m%s\033[0m'...",
                gameListFileString.toStdString().c_str());
         fflush(stdout);
-        if (gameListFile.open(QIODevice::WriteOnly)) {
+        if (gameList.open()) {
             state = NO_INTR; // Ignore ctrl+c
-            gameListFile.write(finalOutput.toUtf8());
+            frontend->assembleList(gameList, gameEntries);
+            const bool written = gameList.commit();
             state = SINGLE;
-            gameListFile.close();
-            printf("\033[1;32mSuccess!\033[0m\n\n");
+            if (written) {
+                printf(" \033[1;32mSuccess!\033[0m\n\n");
+            } else {
+                printf(" \033[1;31mCouldn't write the file! The existing "
+                       "game list was left as it was.\033[0m\n");
+            }
         } else {
-            printf("\033[1;31mCouldn't open file for writing!\nAll that work "
-                   "for nothing... :(\033[0m\n");
+            printf(" \033[1;31mCouldn't open file for writing!\nAll that "
+                   "work for nothing... :(\033[0m\n");
         }
     } else {
         printf("\033[1;34m---- Resource gathering run completed! YAY! "
@@ -942,6 +994,18 @@ void Skyscraper::loadConfig(const QCommandLineParser &parser) {
         config.subdirs = false;
     }
 
+    // With threads="auto" start from the most that could be of use. The module
+    // limits further down still apply, the pipeline then tunes the number of
+    // threads actually scraping while running
+    if (config.threadsAuto) {
+        if (config.scraper == "cache" || config.scraper == "import" ||
+            config.scraper == "esgamelist") {
+            config.threads = qMax(1, QThread::idealThreadCount());
+        } else {
+            config.threads = 8;
+        }
+    }
+
     // If interactive is set, force 1 thread and always accept the chosen result
     // but only on selected scrape modules
     if (config.interactive) {
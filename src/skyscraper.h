@@ -31,6 +31,7 @@
 #include "netcomm.h"
 #include "netmanager.h"
 #include "platform.h"
+#include "reportwriter.h"
 #include "scraperworker.h"
 #include "settings.h"
 
@@ -39,6 +40,7 @@
 #include <QFile>
 #include <QList>
 #include <QObject>
+#include <QTimer>
 
 class Skyscraper : public QObject {
     Q_OBJECT
@@ -47,6 +49,7 @@ public:
     Skyscraper(const QCommandLineParser &parser, const QString &currentDir);
     ~Skyscraper();
     QSharedPointer<Queue> queue;
+    // For the requests of the main thread, the scraper threads have their own
     QSharedPointer<NetManager> manager;
     enum OpMode { SINGLE, NO_INTR, CACHE_EDIT, THREADED };
     int state = SINGLE;
@@ -58,9 +61,10 @@ signals:
     void finished();
 
 private slots:
-    void entryReady(const GameEntry &entry, const QString &output,
-                    const QString &debug);
+    void entryReady(QSharedPointer<ScrapeResult> result);
     void checkThreads();
+    void checkDiskSpace();
+    void threadsTuned(int active, int max);
 
 private:
     Settings config;
@@ -92,15 +96,19 @@ private:
     AbstractFrontend *frontend;
 
     QSharedPointer<Cache> cache;
+    QSharedPointer<ScrapePipeline> pipeline;
+    QSharedPointer<ReportWriter> reportWriter;
+    // Samples the free disk space while scraping when 'spaceCheck' is set
+    QTimer spaceTimer;
 
     QList<GameEntry> gameEntries;
     QList<QString> cliFiles;
     QMutex entryMutex;
     QMutex checkThreadMutex;
     QElapsedTimer timer;
+    qint64 lastProgress = 0; // For the progress line of 'quiet'
     QString gameListFileString;
     QString skippedFileString;
-    int doneThreads;
     int notFound;
     int found;
     int avgSearchMatch;
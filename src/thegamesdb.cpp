@@ -38,6 +38,8 @@ TheGamesDb::TheGamesDb(Settings *config, QSharedPointer<NetManager> manager)
     baseUrl = "https://api.thegamesdb.net/v1";
     searchUrlPre = baseUrl + "/Games/ByGameName?apikey=";
     gfxUrl = "https://cdn.thegamesdb.net/images/original";
+    // The images come from a CDN without a request limit
+    mediaParallel = 4;
 
     fetchOrder.append(RELEASEDATE);
     fetchOrder.append(DESCRIPTION);
@@ -265,6 +267,22 @@ void TheGamesDb::getMarquee(GameEntry &game) {
     }
 }
 
+QString TheGamesDb::getMediaUrl(const int type, const GameEntry &game) {
+    // Only the first try of each, the fallbacks are requested when needed
+    switch (type) {
+    case COVER:
+        return gfxUrl + "/boxart/front/" + game.id + "-1.jpg";
+    case SCREENSHOT:
+        return gfxUrl + "/screenshots/" + game.id + "-1.jpg";
+    case WHEEL:
+        return gfxUrl + "/clearlogo/" + game.id + ".png";
+    case MARQUEE:
+        return gfxUrl + "/graphical/" + game.id + "-g.jpg";
+    default:
+        return QString();
+    }
+}
+
 void TheGamesDb::loadMaps() {
     genreMap = readJson("tgdb_genres.json");
     developerMap = readJson("tgdb_developers.json");
@@ -0,0 +1,42 @@
+QT += core network testlib
+TEMPLATE = app
+TARGET = test_abstractscraper
+DEPENDPATH += .
+INCLUDEPATH += ../../src
+CONFIG += debug
+QT += core network xml
+QMAKE_CXXFLAGS += -std=c++17
+
+CONFIG(release, debug|release):DEFINES += QT_NO_DEBUG_OUTPUT
+
+include(../../VERSION)
+DEFINES+=TESTING
+DEFINES+=VERSION=\\\"$$VERSION\\\"
+
+HEADERS += ../../src/abstractscraper.h \
+           ../../src/coalescer.h \
+           ../../src/gameentry.h \
+           ../../src/httpcache.h \
+           ../../src/nametools.h \
+           ../../src/netarchive.h \
+           ../../src/netcomm.h \
+           ../../src/netmanager.h \
+           ../../src/platform.h \
+           ../../src/ratelimiter.h \
+           ../../src/retrypolicy.h \
+           ../../src/strtools.h 
+
+SOURCES += test_abstractscraper.cpp \
+           ../../src/abstractscraper.cpp \
+           ../../src/coalescer.cpp \
+           ../../src/gameentry.cpp \
+           ../../src/httpcache.cpp \
+           ../../src/nametools.cpp \
+           ../../src/netarchive.cpp \
+           ../../src/netcomm.cpp \
+           ../../src/netmanager.cpp \
+           ../../src/platform.cpp \
+           ../../src/ratelimiter.cpp \
+           ../../src/retrypolicy.cpp \
+           ../../src/strtools.cpp 
+
@@ -0,0 +1,171 @@
+#include "boundedqueue.h"
+
+#include <QTest>
+#include <atomic>
+#include <thread>
+
+class TestBoundedQueue : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testFifo() {
+        BoundedQueue<int> queue(3);
+        QVERIFY(queue.push(1));
+        QVERIFY(queue.push(2));
+        QVERIFY(queue.push(3));
+        int item = 0;
+        for (int expected = 1; expected <= 3; ++expected) {
+            QVERIFY(queue.pop(item));
+            QCOMPARE(item, expected);
+        }
+    }
+
+    void testPushWaitsWhileFull() {
+        BoundedQueue<int> queue(2);
+        QVERIFY(queue.push(1));
+        QVERIFY(queue.push(2));
+        std::atomic<bool> pushed(false);
+        std::thread producer([&]() {
+            queue.push(3);
+            pushed = true;
+        });
+        QTest::qSleep(100);
+        const bool pushedEarly = pushed;
+        int item = 0;
+        QVERIFY(queue.pop(item));
+        producer.join();
+        QVERIFY(!pushedEarly);
+        QVERIFY(pushed);
+        QVERIFY(queue.pop(item));
+        QCOMPARE(item, 2);
+        QVERIFY(queue.pop(item));
+        QCOMPARE(item, 3);
+    }
+
+    void testAtLeastOneItem() {
+        BoundedQueue<int> queue(0);
+        QVERIFY(queue.push(1));
+        std::atomic<bool> pushed(false);
+        std::thread producer([&]() {
+            queue.push(2);
+            pushed = true;
+        });
+        QTest::qSleep(100);
+        const bool pushedEarly = pushed;
+        queue.close();
+        producer.join();
+        QVERIFY(!pushedEarly);
+    }
+
+    void testPopWaitsWhileEmpty() {
+        BoundedQueue<int> queue(2);
+        std::atomic<int> popped(0);
+        std::thread consumer([&]() {
+            int item = 0;
+            if (queue.pop(item)) {
+                popped = item;
+            }
+        });
+        QTest::qSleep(100);
+        const int poppedEarly = popped;
+        QVERIFY(queue.push(7));
+        consumer.join();
+        QCOMPARE(poppedEarly, 0);
+        QCOMPARE((int)popped, 7);
+    }
+
+    void testCloseWakesPop() {
+        BoundedQueue<int> queue(2);
+        std::atomic<bool> result(true);
+        std::thread consumer([&]() {
+            int item = 0;
+            result = queue.pop(item);
+        });
+        QTest::qSleep(50);
+        queue.close();
+        consumer.join();
+        QVERIFY(!result);
+    }
+
+    void testCloseWakesPush() {
+        BoundedQueue<int> queue(1);
+        QVERIFY(queue.push(1));
+        std::atomic<bool> result(true);
+        std::thread producer([&]() { result = queue.push(2); });
+        QTest::qSleep(50);
+        queue.close();
+        producer.join();
+        QVERIFY(!result);
+        // What was queued before is still handed out
+        int item = 0;
+        QVERIFY(queue.pop(item));
+        QCOMPARE(item, 1);
+        QVERIFY(!queue.pop(item));
+    }
+
+    void testNoPushAfterClose() {
+        BoundedQueue<int> queue(2);
+        queue.close();
+        QVERIFY(!queue.push(1));
+        std::deque<int> batch;
+        QVERIFY(!queue.popAll(batch));
+        QVERIFY(batch.empty());
+    }
+
+    void testPopAll() {
+        BoundedQueue<int> queue(3);
+        QVERIFY(queue.push(1));
+        QVERIFY(queue.push(2));
+        QVERIFY(queue.push(3));
+        std::atomic<bool> pushed(false);
+        std::thread producer([&]() {
+            queue.push(4);
+            pushed = true;
+        });
+        std::deque<int> batch = {0};
+        QVERIFY(queue.popAll(batch));
+        producer.join();
+        QCOMPARE((int)batch.size(), 4);
+        QCOMPARE(batch.back(), 3);
+        QVERIFY(pushed);
+        int item = 0;
+        QVERIFY(queue.pop(item));
+        QCOMPARE(item, 4);
+    }
+
+    void testClearWakesPush() {
+        BoundedQueue<int> queue(1);
+        QVERIFY(queue.push(1));
+        std::thread producer([&]() { queue.push(2); });
+        QTest::qSleep(50);
+        queue.clear();
+        producer.join();
+        int item = 0;
+        QVERIFY(queue.pop(item));
+        QCOMPARE(item, 2);
+    }
+
+    void testProducerConsumer() {
+        BoundedQueue<int> queue(4);
+        const int count = 10000;
+        std::thread producer([&]() {
+            for (int i = 0; i < count; ++i) {
+                queue.push(i);
+            }
+            queue.close();
+        });
+        int expected = 0;
+        bool inOrder = true;
+        int item = 0;
+        while (queue.pop(item)) {
+            inOrder = inOrder && item == expected;
+            ++expected;
+        }
+        producer.join();
+        QVERIFY(inOrder);
+        QCOMPARE(expected, count);
+    }
+};
+
+QTEST_MAIN(TestBoundedQueue)
+#include "test_boundedqueue.moc"
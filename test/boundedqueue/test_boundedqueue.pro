@@ -0,0 +1,13 @@
+QT += core testlib
+TEMPLATE = app
+TARGET = test_boundedqueue
+DEPENDPATH += .
+INCLUDEPATH += ../../src
+CONFIG += debug
+QMAKE_CXXFLAGS += -std=c++17
+
+CONFIG(release, debug|release):DEFINES += QT_NO_DEBUG_OUTPUT
+
+HEADERS += ../../src/boundedqueue.h
+
+SOURCES += test_boundedqueue.cpp
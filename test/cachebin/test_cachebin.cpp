@@ -0,0 +1,128 @@
+#include "cache.h"
+#include "cachebin.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+static Resource makeResource(const QString &cacheId, const QString &type,
+                             const QString &source, const QString &value,
+                             const qint64 timestamp) {
+    Resource resource;
+    resource.cacheId = cacheId;
+    resource.type = type;
+    resource.source = source;
+    resource.value = value;
+    resource.timestamp = timestamp;
+    return resource;
+}
+
+class TestCacheBin : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir dir;
+
+    QString binPath() { return dir.filePath("db.bin"); }
+
+    void writeSample() {
+        QHash<QString, QList<Resource>> resources;
+        resources["b"] = {
+            makeResource("b", "title", "screenscraper", "Game B", 2),
+            makeResource("b", "cover", "screenscraper", "blobs/ab/abcd", 3)};
+        resources["a"] = {
+            makeResource("a", "title", "thegamesdb", "Game Ä", 1)};
+        CacheBin bin;
+        QVERIFY(bin.save(binPath(), resources, QSet<QString>()));
+    }
+
+private slots:
+    void testRoundTrip() {
+        writeSample();
+        CacheBin bin;
+        QVERIFY(bin.open(binPath()));
+        QCOMPARE(bin.idCount(), 2);
+        QCOMPARE(bin.resourceCount(), 3);
+        QCOMPARE(bin.cacheIdAt(0), QString("a"));
+        QCOMPARE(bin.cacheIdAt(1), QString("b"));
+        QCOMPARE(bin.resourceCount("b"), 2);
+        QCOMPARE(bin.resourceCount("c"), 0);
+
+        const QList<Resource> romResources = bin.getResources("b");
+        QCOMPARE(romResources.size(), 2);
+        QCOMPARE(romResources[0].cacheId, QString("b"));
+        QCOMPARE(romResources[0].type, QString("title"));
+        QCOMPARE(romResources[0].source, QString("screenscraper"));
+        QCOMPARE(romResources[0].value, QString("Game B"));
+        QCOMPARE(romResources[0].timestamp, (qint64)2);
+        QCOMPARE(romResources[1].value, QString("blobs/ab/abcd"));
+        QCOMPARE(bin.getResources("a")[0].value, QString("Game Ä"));
+
+        const QMap<QPair<QString, QString>, int> typeCounts =
+            bin.getTypeCounts();
+        QCOMPARE(typeCounts.value(qMakePair(QString("screenscraper"),
+                                            QString("title"))),
+                 1);
+        QCOMPARE(typeCounts.value(qMakePair(QString("thegamesdb"),
+                                            QString("title"))),
+                 1);
+        QCOMPARE(bin.getBlobRefs(QSet<QString>()).value("blobs/ab/abcd"), 1);
+        QVERIFY(bin.getBlobRefs({"b"}).isEmpty());
+    }
+
+    void testSaveKeepsOtherIds() {
+        writeSample();
+        CacheBin bin;
+        QVERIFY(bin.open(binPath()));
+        QHash<QString, QList<Resource>> resources;
+        resources["b"] = {
+            makeResource("b", "title", "screenscraper", "Game B2", 4)};
+        QVERIFY(bin.save(binPath(), resources, {"b"}));
+        QVERIFY(!bin.isOpen());
+
+        QVERIFY(bin.open(binPath()));
+        QCOMPARE(bin.resourceCount(), 2);
+        QCOMPARE(bin.getResources("a")[0].value, QString("Game Ä"));
+        QCOMPARE(bin.getResources("b")[0].value, QString("Game B2"));
+    }
+
+    void testEmptyDb() {
+        CacheBin bin;
+        QVERIFY(bin.save(binPath(), QHash<QString, QList<Resource>>(),
+                         QSet<QString>()));
+        QVERIFY(bin.open(binPath()));
+        QCOMPARE(bin.idCount(), 0);
+        QCOMPARE(bin.resourceCount(), 0);
+        QVERIFY(bin.getResources("a").isEmpty());
+        QVERIFY(bin.cacheIdAt(0).isEmpty());
+        QVERIFY(bin.getTypeCounts().isEmpty());
+    }
+
+    void testTruncatedFile() {
+        writeSample();
+        QFile binFile(binPath());
+        const qint64 size = binFile.size();
+        QVERIFY(binFile.resize(size - 1));
+        CacheBin bin;
+        QVERIFY(!bin.open(binPath()));
+        QVERIFY(!bin.isOpen());
+        // Not even a complete header
+        QVERIFY(binFile.resize(16));
+        QVERIFY(!bin.open(binPath()));
+        QVERIFY(binFile.resize(0));
+        QVERIFY(!bin.open(binPath()));
+    }
+
+    void testInvalidMagic() {
+        writeSample();
+        QFile binFile(binPath());
+        QVERIFY(binFile.open(QIODevice::ReadWrite));
+        binFile.write("NOTSKYDB");
+        binFile.close();
+        CacheBin bin;
+        QVERIFY(!bin.open(binPath()));
+    }
+};
+
+QTEST_MAIN(TestCacheBin)
+#include "test_cachebin.moc"
@@ -0,0 +1,14 @@
+QT += core testlib
+TEMPLATE = app
+TARGET = test_cachebin
+DEPENDPATH += .
+INCLUDEPATH += ../../src
+CONFIG += debug
+QMAKE_CXXFLAGS += -std=c++17
+
+CONFIG(release, debug|release):DEFINES += QT_NO_DEBUG_OUTPUT
+
+HEADERS += ../../src/cachebin.h
+
+SOURCES += test_cachebin.cpp \
+           ../../src/cachebin.cpp
@@ -0,0 +1,119 @@
+#include "coalescer.h"
+
+#include <QTest>
+#include <atomic>
+#include <thread>
+
+static Coalescer::Response makeResponse(const QByteArray &data) {
+    return {data, QNetworkReply::NoError, "text/plain", "", 200, {}};
+}
+
+class TestCoalescer : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testLeaderThenBusy() {
+        Coalescer coalescer;
+        Coalescer::Response response;
+        QCOMPARE(coalescer.join("a", response), Coalescer::LEADER);
+        QCOMPARE(coalescer.join("a", response, false), Coalescer::BUSY);
+        // Other keys aren't held up
+        QCOMPARE(coalescer.join("b", response, false), Coalescer::LEADER);
+        QVERIFY(!coalescer.isAwaited("a"));
+        coalescer.abandon("a");
+        coalescer.abandon("b");
+    }
+
+    void testJoinWaitsForFinish() {
+        Coalescer coalescer;
+        Coalescer::Response response;
+        QCOMPARE(coalescer.join("a", response), Coalescer::LEADER);
+        Coalescer::Role role = Coalescer::BUSY;
+        Coalescer::Response shared;
+        std::thread waiter([&]() { role = coalescer.join("a", shared); });
+        QTRY_VERIFY(coalescer.isAwaited("a"));
+        coalescer.finish("a", makeResponse("data"), false);
+        waiter.join();
+        QCOMPARE(role, Coalescer::SERVED);
+        QCOMPARE(shared.data, QByteArray("data"));
+        QCOMPARE(shared.httpStatus, 200);
+        QVERIFY(!coalescer.isAwaited("a"));
+    }
+
+    void testFinishWithoutKeep() {
+        Coalescer coalescer;
+        Coalescer::Response response;
+        QCOMPARE(coalescer.join("a", response), Coalescer::LEADER);
+        coalescer.finish("a", makeResponse("data"), false);
+        QCOMPARE(coalescer.join("a", response), Coalescer::LEADER);
+        coalescer.abandon("a");
+    }
+
+    void testAbandonHandsOverLead() {
+        Coalescer coalescer;
+        Coalescer::Response response;
+        QCOMPARE(coalescer.join("a", response), Coalescer::LEADER);
+        std::atomic<Coalescer::Role> roles[2] = {{Coalescer::BUSY},
+                                                 {Coalescer::BUSY}};
+        Coalescer::Response shared[2];
+        std::thread first([&]() { roles[0] = coalescer.join("a", shared[0]); });
+        std::thread second(
+            [&]() { roles[1] = coalescer.join("a", shared[1]); });
+        QTRY_VERIFY(coalescer.isAwaited("a"));
+        coalescer.abandon("a");
+        // One of them takes over and the other waits for it
+        QTRY_VERIFY(roles[0] == Coalescer::LEADER ||
+                    roles[1] == Coalescer::LEADER);
+        QTRY_VERIFY(coalescer.isAwaited("a"));
+        coalescer.finish("a", makeResponse("retried"), false);
+        first.join();
+        second.join();
+        QVERIFY((roles[0] == Coalescer::LEADER &&
+                 roles[1] == Coalescer::SERVED) ||
+                (roles[0] == Coalescer::SERVED &&
+                 roles[1] == Coalescer::LEADER));
+        const int served = roles[0] == Coalescer::SERVED ? 0 : 1;
+        QCOMPARE(shared[served].data, QByteArray("retried"));
+    }
+
+    void testKeptResponseIsServed() {
+        Coalescer coalescer;
+        Coalescer::Response response;
+        QCOMPARE(coalescer.join("a", response), Coalescer::LEADER);
+        coalescer.finish("a", makeResponse("data"), true);
+        Coalescer::Response repeat;
+        QCOMPARE(coalescer.join("a", repeat, false), Coalescer::SERVED);
+        QCOMPARE(repeat.data, QByteArray("data"));
+        QCOMPARE(repeat.contentType, QByteArray("text/plain"));
+        QCOMPARE(coalescer.join("b", repeat, false), Coalescer::LEADER);
+        coalescer.abandon("b");
+    }
+
+    void testLargeResponseNotKept() {
+        Coalescer coalescer;
+        Coalescer::Response response;
+        QCOMPARE(coalescer.join("a", response), Coalescer::LEADER);
+        coalescer.finish("a", makeResponse(QByteArray(9 * 1000 * 1000, 'x')),
+                         true);
+        QCOMPARE(coalescer.join("a", response), Coalescer::LEADER);
+        coalescer.abandon("a");
+    }
+
+    void testKeptSizeIsCapped() {
+        Coalescer coalescer;
+        Coalescer::Response response;
+        const QByteArray data(7 * 1000 * 1000, 'x');
+        for (int i = 0; i < 10; ++i) {
+            const QString key = QString::number(i);
+            QCOMPARE(coalescer.join(key, response), Coalescer::LEADER);
+            coalescer.finish(key, makeResponse(data), true);
+        }
+        // The oldest made way for the newer ones
+        QCOMPARE(coalescer.join("0", response, false), Coalescer::LEADER);
+        coalescer.abandon("0");
+        QCOMPARE(coalescer.join("9", response, false), Coalescer::SERVED);
+    }
+};
+
+QTEST_MAIN(TestCoalescer)
+#include "test_coalescer.moc"
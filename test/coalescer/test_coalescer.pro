@@ -0,0 +1,14 @@
+QT += core network testlib
+TEMPLATE = app
+TARGET = test_coalescer
+DEPENDPATH += .
+INCLUDEPATH += ../../src
+CONFIG += debug
+QMAKE_CXXFLAGS += -std=c++17
+
+CONFIG(release, debug|release):DEFINES += QT_NO_DEBUG_OUTPUT
+
+HEADERS += ../../src/coalescer.h
+
+SOURCES += test_coalescer.cpp \
+           ../../src/coalescer.cpp
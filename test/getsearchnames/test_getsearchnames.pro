@@ -17,16 +17,21 @@ DEFINES+=VERSION=\\\"$$VERSION\\\"
 HEADERS += ../../src/abstractscraper.h  \ 
              ../../src/arcadedb.h \
              ../../src/cli.h \
+             ../../src/coalescer.h \
              ../../src/crc32.h \
              ../../src/esgamelist.h \
              ../../src/gameentry.h \
+             ../../src/httpcache.h \
              ../../src/igdb.h \
              ../../src/mobygames.h \
              ../../src/nametools.h \
+             ../../src/netarchive.h \
              ../../src/netcomm.h \
              ../../src/netmanager.h \
              ../../src/openretro.h \
              ../../src/platform.h \
+             ../../src/ratelimiter.h \
+             ../../src/retrypolicy.h \
              ../../src/screenscraper.h \
              ../../src/settings.h \
              ../../src/strtools.h 
@@ -35,16 +40,21 @@ SOURCES +=  test_getsearchnames.cpp \
              ../../src/abstractscraper.cpp \
              ../../src/arcadedb.cpp \
              ../../src/cli.cpp \
+             ../../src/coalescer.cpp \
              ../../src/crc32.cpp \
              ../../src/esgamelist.cpp \
              ../../src/gameentry.cpp \
+             ../../src/httpcache.cpp \
              ../../src/igdb.cpp \
              ../../src/mobygames.cpp \
              ../../src/nametools.cpp \
+             ../../src/netarchive.cpp \
              ../../src/netcomm.cpp \
              ../../src/netmanager.cpp \
              ../../src/openretro.cpp \
              ../../src/platform.cpp \
+             ../../src/ratelimiter.cpp \
+             ../../src/retrypolicy.cpp \
              ../../src/screenscraper.cpp \
              ../../src/settings.cpp \
              ../../src/strtools.cpp
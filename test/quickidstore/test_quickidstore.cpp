@@ -0,0 +1,155 @@
+#include "quickidstore.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+class TestQuickIdStore : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir dir;
+
+    QString binPath() { return dir.filePath("quickid.bin"); }
+    QString xmlPath() { return dir.filePath("quickid.xml"); }
+
+    QString writeRom(const QString &name, const QByteArray &data) {
+        const QString filePath = dir.filePath(name);
+        QFile romFile(filePath);
+        if (romFile.open(QIODevice::WriteOnly)) {
+            romFile.write(data);
+        }
+        return filePath;
+    }
+
+private slots:
+    void cleanup() {
+        QFile::remove(binPath());
+        QFile::remove(xmlPath());
+    }
+
+    void testRoundTrip() {
+        const QString romPath = writeRom("game.zip", "rom data");
+        QuickIdStore store;
+        QVERIFY(!store.load(binPath(), xmlPath()));
+        store.add(QFileInfo(romPath), "cacheid");
+        QVERIFY(store.isDirty());
+        QVERIFY(store.save(binPath(), xmlPath()));
+        QVERIFY(!store.isDirty());
+
+        QuickIdStore loaded;
+        QVERIFY(loaded.load(binPath(), xmlPath()));
+        QCOMPARE(loaded.size(), 1);
+        QVERIFY(!loaded.isDirty());
+        QCOMPARE(loaded.get(QFileInfo(romPath)), QString("cacheid"));
+    }
+
+    void testChangedSizeIsStale() {
+        const QString romPath = writeRom("size.zip", "rom data");
+        QuickIdStore store;
+        store.add(QFileInfo(romPath), "cacheid");
+        const QDateTime modified = QFileInfo(romPath).lastModified();
+        writeRom("size.zip", "other rom data");
+        // Only the size gives it away
+        QFile romFile(romPath);
+        QVERIFY(romFile.open(QIODevice::ReadWrite));
+        QVERIFY(
+            romFile.setFileTime(modified, QFileDevice::FileModificationTime));
+        romFile.close();
+        QVERIFY(store.get(QFileInfo(romPath)).isEmpty());
+    }
+
+    void testNewerFileIsStale() {
+        const QString romPath = writeRom("newer.zip", "rom data");
+        QuickIdStore store;
+        store.add(QFileInfo(romPath), "cacheid");
+        QFile romFile(romPath);
+        QVERIFY(romFile.open(QIODevice::ReadWrite));
+        QVERIFY(romFile.setFileTime(
+            QFileInfo(romPath).lastModified().addSecs(60),
+            QFileDevice::FileModificationTime));
+        romFile.close();
+        QVERIFY(store.get(QFileInfo(romPath)).isEmpty());
+    }
+
+    void testRetainDropsOthers() {
+        const QString keptPath = writeRom("kept.zip", "kept");
+        const QString droppedPath = writeRom("dropped.zip", "dropped");
+        QuickIdStore store;
+        store.add(QFileInfo(keptPath), "kept");
+        store.add(QFileInfo(droppedPath), "dropped");
+        QVERIFY(store.save(binPath(), xmlPath()));
+        store.retain({QFileInfo(keptPath)});
+        QVERIFY(store.isDirty());
+        QCOMPARE(store.size(), 1);
+        QCOMPARE(store.get(QFileInfo(keptPath)), QString("kept"));
+        QVERIFY(store.get(QFileInfo(droppedPath)).isEmpty());
+    }
+
+#if !defined(Q_OS_WIN)
+    void testRenamedFileIsFound() {
+        const QString oldPath = writeRom("old.zip", "renamed rom");
+        QuickIdStore store;
+        store.add(QFileInfo(oldPath), "cacheid");
+        const QString newPath = dir.filePath("new.zip");
+        QVERIFY(QFile::rename(oldPath, newPath));
+        QCOMPARE(store.get(QFileInfo(newPath)), QString("cacheid"));
+        QCOMPARE(store.size(), 1);
+    }
+#endif
+
+    void testCorruptFile() {
+        QFile binFile(binPath());
+        QVERIFY(binFile.open(QIODevice::WriteOnly));
+        binFile.write("not a quick id file");
+        binFile.close();
+        QuickIdStore store;
+        QVERIFY(!store.load(binPath(), xmlPath()));
+        QCOMPARE(store.size(), 0);
+    }
+
+    void testTruncatedFile() {
+        const QString romPath = writeRom("truncated.zip", "rom data");
+        QuickIdStore store;
+        store.add(QFileInfo(romPath), "cacheid");
+        store.add(QFileInfo(writeRom("other.zip", "other")), "other");
+        QVERIFY(store.save(binPath(), xmlPath()));
+        QFile binFile(binPath());
+        QVERIFY(binFile.resize(binFile.size() - 4));
+        // Nothing of a partly read file is used
+        QuickIdStore loaded;
+        QVERIFY(!loaded.load(binPath(), xmlPath()));
+        QCOMPARE(loaded.size(), 0);
+    }
+
+    void testCorruptFileFallsBackToXml() {
+        const QString romPath = writeRom("xml.zip", "rom data");
+        QFile binFile(binPath());
+        QVERIFY(binFile.open(QIODevice::WriteOnly));
+        QDataStream out(&binFile);
+        out << (quint32)99 << (quint32)1;
+        binFile.close();
+        QFile xmlFile(xmlPath());
+        QVERIFY(xmlFile.open(QIODevice::WriteOnly));
+        xmlFile.write(
+            QString("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<quickids>\n"
+                    "  <quickid filepath=\"%1\" timestamp=\"%2\" "
+                    "id=\"cacheid\"/>\n</quickids>\n")
+                .arg(QFileInfo(romPath).absoluteFilePath())
+                .arg(QFileInfo(romPath).lastModified().toMSecsSinceEpoch())
+                .toUtf8());
+        xmlFile.close();
+        QuickIdStore store;
+        QVERIFY(store.load(binPath(), xmlPath()));
+        QCOMPARE(store.get(QFileInfo(romPath)), QString("cacheid"));
+        // The import is written to 'quickid.bin' and the xml removed
+        QVERIFY(store.isDirty());
+        QVERIFY(store.save(binPath(), xmlPath()));
+        QVERIFY(!QFileInfo::exists(xmlPath()));
+    }
+};
+
+QTEST_MAIN(TestQuickIdStore)
+#include "test_quickidstore.moc"
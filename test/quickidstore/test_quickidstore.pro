@@ -0,0 +1,14 @@
+QT += core testlib
+TEMPLATE = app
+TARGET = test_quickidstore
+DEPENDPATH += .
+INCLUDEPATH += ../../src
+CONFIG += debug
+QMAKE_CXXFLAGS += -std=c++17
+
+CONFIG(release, debug|release):DEFINES += QT_NO_DEBUG_OUTPUT
+
+HEADERS += ../../src/quickidstore.h
+
+SOURCES += test_quickidstore.cpp \
+           ../../src/quickidstore.cpp
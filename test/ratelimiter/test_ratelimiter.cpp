@@ -0,0 +1,81 @@
+#include "ratelimiter.h"
+
+#include <QElapsedTimer>
+#include <QTest>
+
+class TestRateLimiter : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testBackOffDoubles() {
+        RateLimiter limiter("test", 100, 1);
+        QCOMPARE(limiter.getInterval(), 100);
+        limiter.backOff();
+        QCOMPARE(limiter.getInterval(), 200);
+        limiter.backOff();
+        QCOMPARE(limiter.getInterval(), 400);
+    }
+
+    void testBackOffStopsAt16x() {
+        RateLimiter limiter("test", 100, 1);
+        for (int i = 0; i < 10; ++i) {
+            limiter.backOff();
+        }
+        QCOMPARE(limiter.getInterval(), 1600);
+    }
+
+    void testSucceededHalvesAfter10() {
+        RateLimiter limiter("test", 100, 1);
+        limiter.backOff();
+        limiter.backOff();
+        for (int i = 0; i < 9; ++i) {
+            limiter.succeeded();
+        }
+        QCOMPARE(limiter.getInterval(), 400);
+        limiter.succeeded();
+        QCOMPARE(limiter.getInterval(), 200);
+        for (int i = 0; i < 10; ++i) {
+            limiter.succeeded();
+        }
+        QCOMPARE(limiter.getInterval(), 100);
+        // Never faster than configured
+        for (int i = 0; i < 10; ++i) {
+            limiter.succeeded();
+        }
+        QCOMPARE(limiter.getInterval(), 100);
+    }
+
+    void testBackOffRestartsRecovery() {
+        RateLimiter limiter("test", 100, 1);
+        limiter.backOff();
+        for (int i = 0; i < 9; ++i) {
+            limiter.succeeded();
+        }
+        limiter.backOff();
+        for (int i = 0; i < 9; ++i) {
+            limiter.succeeded();
+        }
+        QCOMPARE(limiter.getInterval(), 400);
+    }
+
+    void testAcquireWaitsForToken() {
+        RateLimiter limiter("test", 200, 1);
+        QElapsedTimer timer;
+        timer.start();
+        // The first token is there from the start
+        limiter.acquire();
+        QVERIFY(timer.elapsed() < 100);
+        limiter.acquire();
+        QVERIFY(timer.elapsed() >= 150);
+    }
+
+    void testGetSharesByName() {
+        QSharedPointer<RateLimiter> first = RateLimiter::get("shared", 100);
+        QSharedPointer<RateLimiter> second = RateLimiter::get("shared", 500);
+        QCOMPARE(first.data(), second.data());
+        QCOMPARE(second->getInterval(), 100);
+    }
+};
+
+QTEST_MAIN(TestRateLimiter)
+#include "test_ratelimiter.moc"
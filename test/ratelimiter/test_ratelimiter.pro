@@ -0,0 +1,14 @@
+QT += core testlib
+TEMPLATE = app
+TARGET = test_ratelimiter
+DEPENDPATH += .
+INCLUDEPATH += ../../src
+CONFIG += debug
+QMAKE_CXXFLAGS += -std=c++17
+
+CONFIG(release, debug|release):DEFINES += QT_NO_DEBUG_OUTPUT
+
+HEADERS += ../../src/ratelimiter.h
+
+SOURCES += test_ratelimiter.cpp \
+           ../../src/ratelimiter.cpp
@@ -0,0 +1,137 @@
+#include "retrypolicy.h"
+
+#include <QElapsedTimer>
+#include <QTest>
+#include <atomic>
+#include <thread>
+
+class TestRetryPolicy : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testClassify() {
+        QCOMPARE(RetryPolicy::classify(QNetworkReply::NoError, 200, ""),
+                 RetryPolicy::DONE);
+        QCOMPARE(RetryPolicy::classify(QNetworkReply::NoError, 429, ""),
+                 RetryPolicy::OVERLOADED);
+        QCOMPARE(RetryPolicy::classify(QNetworkReply::NoError, 502, ""),
+                 RetryPolicy::RETRY);
+        QCOMPARE(RetryPolicy::classify(QNetworkReply::TimeoutError, 0, ""),
+                 RetryPolicy::RETRY);
+        QCOMPARE(RetryPolicy::classify(
+                     QNetworkReply::ContentNotFoundError, 404, ""),
+                 RetryPolicy::DONE);
+    }
+
+    void testRetryDelay() {
+        RetryPolicy policy("test");
+        QCOMPARE(policy.retryDelay(RetryPolicy::DONE, 0), -1);
+        int delay = policy.retryDelay(RetryPolicy::RETRY, 0);
+        QVERIFY(delay >= 500 && delay <= 1000);
+        delay = policy.retryDelay(RetryPolicy::RETRY, 1);
+        QVERIFY(delay >= 1000 && delay <= 2000);
+        delay = policy.retryDelay(RetryPolicy::OVERLOADED, 2);
+        QVERIFY(delay >= 2000 && delay <= 4000);
+        // Four attempts in all
+        QCOMPARE(policy.retryDelay(RetryPolicy::RETRY, 3), -1);
+    }
+
+    void testRetryAfter() {
+        RetryPolicy policy("test");
+        QCOMPARE(policy.retryDelay(RetryPolicy::OVERLOADED, 0, 20), 20000);
+        // Capped at the longest cooldown
+        QCOMPARE(policy.retryDelay(RetryPolicy::OVERLOADED, 0, 3600), 300000);
+        // Never shorter than the backoff
+        const int delay = policy.retryDelay(RetryPolicy::RETRY, 2, 1);
+        QVERIFY(delay >= 2000 && delay <= 4000);
+    }
+
+    void testRetryBudget() {
+        RetryPolicy policy("test");
+        for (int i = 0; i < 10; ++i) {
+            QVERIFY(policy.retryDelay(RetryPolicy::RETRY, 0) >= 0);
+        }
+        QCOMPARE(policy.retryDelay(RetryPolicy::RETRY, 0), -1);
+        // A fifth of a retry for every request that goes through
+        for (int i = 0; i < 4; ++i) {
+            policy.record(RetryPolicy::DONE);
+        }
+        QCOMPARE(policy.retryDelay(RetryPolicy::RETRY, 0), -1);
+        policy.record(RetryPolicy::DONE);
+        QVERIFY(policy.retryDelay(RetryPolicy::RETRY, 0) >= 0);
+        QCOMPARE(policy.retryDelay(RetryPolicy::RETRY, 0), -1);
+    }
+
+    void testOverloadedOpens() {
+        RetryPolicy policy("test", 100);
+        QVERIFY(policy.tryPass());
+        policy.record(RetryPolicy::OVERLOADED);
+        QVERIFY(!policy.tryPass());
+        QTest::qSleep(150);
+        // Half open, a single probe goes through
+        QVERIFY(policy.tryPass());
+        QVERIFY(!policy.tryPass());
+        policy.record(RetryPolicy::DONE);
+        QVERIFY(policy.tryPass());
+        QVERIFY(policy.tryPass());
+    }
+
+    void testFailuresTrip() {
+        RetryPolicy policy("test", 100);
+        for (int i = 0; i < 4; ++i) {
+            policy.record(RetryPolicy::RETRY);
+        }
+        QVERIFY(policy.tryPass());
+        policy.record(RetryPolicy::DONE);
+        for (int i = 0; i < 4; ++i) {
+            policy.record(RetryPolicy::RETRY);
+        }
+        QVERIFY(policy.tryPass());
+        policy.record(RetryPolicy::RETRY);
+        QVERIFY(!policy.tryPass());
+    }
+
+    void testFailedProbeReopens() {
+        RetryPolicy policy("test", 100);
+        policy.record(RetryPolicy::OVERLOADED);
+        QTest::qSleep(150);
+        QVERIFY(policy.tryPass());
+        policy.record(RetryPolicy::RETRY);
+        // The cooldown has doubled
+        QTest::qSleep(150);
+        QVERIFY(!policy.tryPass());
+        QTest::qSleep(100);
+        QVERIFY(policy.tryPass());
+    }
+
+    void testPassWaitsForCooldown() {
+        RetryPolicy policy("test", 200);
+        policy.record(RetryPolicy::OVERLOADED);
+        QElapsedTimer timer;
+        timer.start();
+        policy.pass();
+        QVERIFY(timer.elapsed() >= 150);
+        policy.record(RetryPolicy::DONE);
+    }
+
+    void testPassWaitsForProbe() {
+        RetryPolicy policy("test", 100);
+        policy.record(RetryPolicy::OVERLOADED);
+        QTest::qSleep(150);
+        QVERIFY(policy.tryPass());
+        std::atomic<bool> passed(false);
+        std::thread other([&]() {
+            policy.pass();
+            passed = true;
+        });
+        QTest::qSleep(100);
+        const bool passedEarly = passed;
+        policy.record(RetryPolicy::DONE);
+        other.join();
+        QVERIFY(!passedEarly);
+        QVERIFY(passed);
+    }
+};
+
+QTEST_MAIN(TestRetryPolicy)
+#include "test_retrypolicy.moc"
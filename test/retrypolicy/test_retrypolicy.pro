@@ -0,0 +1,14 @@
+QT += core network testlib
+TEMPLATE = app
+TARGET = test_retrypolicy
+DEPENDPATH += .
+INCLUDEPATH += ../../src
+CONFIG += debug
+QMAKE_CXXFLAGS += -std=c++17
+
+CONFIG(release, debug|release):DEFINES += QT_NO_DEBUG_OUTPUT
+
+HEADERS += ../../src/retrypolicy.h
+
+SOURCES += test_retrypolicy.cpp \
+           ../../src/retrypolicy.cpp